@@ -0,0 +1,95 @@
+#include "alloc_tracker.h"
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Counting replacements for the global operator new and delete. Each block
+// carries a small header with its size, so frees are counted in bytes too.
+// Not part of the core library: only executables that list this file get
+// the counting allocator (see CMakeLists.txt).
+
+namespace {
+
+struct Header {
+    void* block; // What malloc returned
+    size_t size;
+};
+
+void* Allocate(size_t size, size_t alignment) noexcept {
+    alignment = alignment < alignof(Header) ? alignof(Header) : alignment;
+    void* block = std::malloc(size + sizeof(Header) + alignment - 1);
+    if (!block) return nullptr;
+
+    const uintptr_t user = (reinterpret_cast<uintptr_t>(block) + sizeof(Header) + alignment - 1) &
+                           ~static_cast<uintptr_t>(alignment - 1);
+    Header* header = reinterpret_cast<Header*>(user) - 1;
+    header->block = block;
+    header->size = size;
+    AllocTracker::OnAllocate(size);
+    return reinterpret_cast<void*>(user);
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment) {
+    for (;;) {
+        if (void* pointer = Allocate(size ? size : 1, alignment)) return pointer;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void Free(void* pointer) noexcept {
+    if (!pointer) return;
+    const Header* header = static_cast<Header*>(pointer) - 1;
+    AllocTracker::OnFree(header->size);
+    std::free(header->block);
+}
+
+const bool installed = (AllocTracker::MarkInstalled(), true);
+
+} // namespace
+
+void* operator new(size_t size) {
+    return AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size) {
+    return AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Allocate(size ? size : 1, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Allocate(size ? size : 1, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept { Free(pointer); }
+void operator delete[](void* pointer) noexcept { Free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { Free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { Free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { Free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { Free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { Free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { Free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { Free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { Free(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { Free(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { Free(pointer); }
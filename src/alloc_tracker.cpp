@@ -0,0 +1,141 @@
+#include "alloc_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace {
+
+struct ScopeCounters {
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> frees{ 0 };
+    std::atomic<uint64_t> allocatedBytes{ 0 };
+    std::atomic<uint64_t> freedBytes{ 0 };
+    AllocCounts frameStart = {}; // Totals at the last EndFrame
+    AllocCounts lastFrame = {};
+};
+
+// Zero-initialized before any constructor runs, so allocations made during
+// static initialization are counted too. Slot 0 is "(unscoped)".
+const char* scopeNames[AllocTracker::MAX_SCOPES];
+ScopeCounters scopes[AllocTracker::MAX_SCOPES];
+std::atomic<int> scopeCount{ 0 };
+std::mutex registerMutex;
+std::atomic<bool> installed{ false };
+thread_local int currentScope = 0;
+
+AllocCounts Load(const ScopeCounters& counters) {
+    return { counters.allocations.load(std::memory_order_relaxed), counters.frees.load(std::memory_order_relaxed),
+             counters.allocatedBytes.load(std::memory_order_relaxed),
+             counters.freedBytes.load(std::memory_order_relaxed) };
+}
+
+AllocCounts Subtract(const AllocCounts& a, const AllocCounts& b) {
+    return { a.allocations - b.allocations, a.frees - b.frees, a.allocatedBytes - b.allocatedBytes,
+             a.freedBytes - b.freedBytes };
+}
+
+void Add(AllocCounts& sum, const AllocCounts& counts) {
+    sum.allocations += counts.allocations;
+    sum.frees += counts.frees;
+    sum.allocatedBytes += counts.allocatedBytes;
+    sum.freedBytes += counts.freedBytes;
+}
+
+int FindScope(const char* name) {
+    const int count = scopeCount.load(std::memory_order_acquire);
+    for (int i = 1; i < count; ++i) {
+        if (scopeNames[i] == name) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+bool AllocTracker::IsInstalled() {
+    return installed.load(std::memory_order_relaxed);
+}
+
+void AllocTracker::MarkInstalled() {
+    installed.store(true, std::memory_order_relaxed);
+}
+
+void AllocTracker::OnAllocate(size_t bytes) {
+    ScopeCounters& counters = scopes[currentScope];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocTracker::OnFree(size_t bytes) {
+    ScopeCounters& counters = scopes[currentScope];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.freedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocTracker::EndFrame() {
+    const int count = std::max(scopeCount.load(std::memory_order_acquire), 1);
+    for (int i = 0; i < count; ++i) {
+        const AllocCounts now = Load(scopes[i]);
+        scopes[i].lastFrame = Subtract(now, scopes[i].frameStart);
+        scopes[i].frameStart = now;
+    }
+}
+
+AllocCounts AllocTracker::GetTotals() {
+    AllocCounts sum = {};
+    const int count = std::max(scopeCount.load(std::memory_order_acquire), 1);
+    for (int i = 0; i < count; ++i) Add(sum, Load(scopes[i]));
+    return sum;
+}
+
+AllocCounts AllocTracker::GetLastFrame() {
+    AllocCounts sum = {};
+    const int count = std::max(scopeCount.load(std::memory_order_acquire), 1);
+    for (int i = 0; i < count; ++i) Add(sum, scopes[i].lastFrame);
+    return sum;
+}
+
+int AllocTracker::GetScopeCount() {
+    return std::max(scopeCount.load(std::memory_order_acquire), 1);
+}
+
+AllocScopeStats AllocTracker::GetScope(int index) {
+    return { index == 0 ? "(unscoped)" : scopeNames[index], Load(scopes[index]), scopes[index].lastFrame };
+}
+
+void AllocTracker::Report(std::FILE* out) {
+    const AllocCounts totals = GetTotals();
+    std::fprintf(out, "heap: %llu allocations (%llu bytes), %llu frees (%llu bytes)\n",
+                 static_cast<unsigned long long>(totals.allocations),
+                 static_cast<unsigned long long>(totals.allocatedBytes),
+                 static_cast<unsigned long long>(totals.frees), static_cast<unsigned long long>(totals.freedBytes));
+    for (int i = 0; i < GetScopeCount(); ++i) {
+        const AllocScopeStats scope = GetScope(i);
+        if (scope.total.allocations == 0 && scope.total.frees == 0) continue;
+        std::fprintf(out, "  %-24s %10llu allocations %12llu bytes %10llu frees\n", scope.name,
+                     static_cast<unsigned long long>(scope.total.allocations),
+                     static_cast<unsigned long long>(scope.total.allocatedBytes),
+                     static_cast<unsigned long long>(scope.total.frees));
+    }
+}
+
+int AllocTracker::EnterScope(const char* name) {
+    const int previous = currentScope;
+    int scope = FindScope(name);
+    if (scope < 0) {
+        // First time this name is seen; registering doesn't allocate
+        std::lock_guard<std::mutex> lock(registerMutex);
+        scope = FindScope(name);
+        const int count = std::max(scopeCount.load(std::memory_order_relaxed), 1);
+        if (scope < 0 && count < MAX_SCOPES) {
+            scopeNames[count] = name;
+            scopeCount.store(count + 1, std::memory_order_release);
+            scope = count;
+        }
+    }
+    currentScope = scope < 0 ? 0 : scope;
+    return previous;
+}
+
+void AllocTracker::LeaveScope(int previous) {
+    currentScope = previous;
+}
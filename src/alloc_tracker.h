@@ -0,0 +1,81 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+// Heap allocation counters. alloc_hooks.cpp replaces the global operator new
+// and delete with versions that report here; it is linked into headless
+// (for --alloc-gate) and, with ASTEROIDS_ALLOC_TRACKING on, into the game.
+// Without the hooks every count stays zero.
+//
+// Counts are kept in total, per frame (between EndFrame calls) and per named
+// scope. With ASTEROIDS_ALLOC_TRACKING defined every PROFILE_SCOPE is also an
+// allocation scope, and allocations outside any scope go to "(unscoped)".
+// Only calls through operator new are seen, not malloc from C libraries.
+
+struct AllocCounts {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t allocatedBytes;
+    uint64_t freedBytes;
+};
+
+struct AllocScopeStats {
+    const char* name;
+    AllocCounts total;
+    AllocCounts lastFrame;
+};
+
+class AllocTracker {
+public:
+    static const int MAX_SCOPES = 64; // Further scopes count as "(unscoped)"
+
+    // True once the counting operator new is linked in
+    static bool IsInstalled();
+    static void MarkInstalled();
+
+    // From the hooks, on any thread
+    static void OnAllocate(size_t bytes);
+    static void OnFree(size_t bytes);
+
+    // Closes the current frame: its counts become the last frame's
+    static void EndFrame();
+    static AllocCounts GetTotals();
+    static AllocCounts GetLastFrame();
+    // Every scope seen so far, "(unscoped)" first
+    static int GetScopeCount();
+    static AllocScopeStats GetScope(int index);
+
+    // Totals and every scope that allocated, for dumping at exit
+    static void Report(std::FILE* out);
+
+    // Used by AllocScope; name must be a string literal (stored by pointer).
+    // Returns the scope to go back to.
+    static int EnterScope(const char* name);
+    static void LeaveScope(int previous);
+};
+
+// Counts this thread's allocations against name until the end of the block
+class AllocScope {
+public:
+    explicit AllocScope(const char* name) : previous(AllocTracker::EnterScope(name)) {}
+    ~AllocScope() { AllocTracker::LeaveScope(previous); }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    int previous;
+};
+
+#ifdef ASTEROIDS_ALLOC_TRACKING
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_SCOPE(name) AllocScope ALLOC_CONCAT(allocScope, __LINE__)(name)
+#else
+#define ALLOC_SCOPE(name) ((void)0)
+#endif
+
+#endif // ALLOC_TRACKER_H
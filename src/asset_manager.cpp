@@ -0,0 +1,258 @@
+#include "asset_manager.h"
+#include "atlas_packer.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+// Set by CMake to the source tree's asset folder
+#ifndef ASSETS_PATH
+#define ASSETS_PATH "assets/"
+#endif
+
+namespace {
+
+const int WHITE_BLOCK_SIZE = 4;  // Texels of white that shapes sample
+const int MAX_ATLAS_SIZE = 4096;
+
+size_t DecodedBytes(const Image& image) {
+    return static_cast<size_t>(image.width) * image.height * 4;
+}
+
+size_t DecodedBytes(const Wave& wave) {
+    return static_cast<size_t>(wave.frameCount) * wave.channels * wave.sampleSize / 8;
+}
+
+}
+
+AssetManager::AssetManager()
+    : stopping(false),
+      spritesInFlight(0),
+      soundsInFlight(0),
+      uploadBudget(4 * 1024 * 1024),
+      atlasDirty(false),
+      atlas() {
+    loader = std::thread(&AssetManager::LoaderLoop, this);
+}
+
+AssetManager::~AssetManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    loader.join();
+
+    // Whatever the GPU never got is still plain CPU memory
+    for (Decoded& item : decoded) {
+        if (item.kind == AssetKind::SPRITE) UnloadImage(item.image);
+        else UnloadWave(item.wave);
+    }
+    for (auto& entry : atlasImages) {
+        UnloadImage(entry.second);
+    }
+}
+
+void AssetManager::LoadTextures() {
+    RequestSprite("ship", ASSETS_PATH "sprites/ship.png");
+    RequestSprite("asteroid", ASSETS_PATH "sprites/asteroid.png");
+}
+
+void AssetManager::LoadSounds() {
+    RequestSound("hit", ASSETS_PATH "sounds/hit.wav");
+    RequestSound("explosion", ASSETS_PATH "sounds/explosion.wav");
+}
+
+void AssetManager::RequestSprite(const std::string& name, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({ AssetKind::SPRITE, name, path });
+        spritesInFlight++;
+    }
+    wake.notify_one();
+}
+
+void AssetManager::RequestSound(const std::string& name, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({ AssetKind::SOUND, name, path });
+        soundsInFlight++;
+    }
+    wake.notify_one();
+}
+
+void AssetManager::Update() {
+    PROFILE_SCOPE("assets");
+
+    // Take what fits in this frame's budget; one asset always goes through so
+    // a large file can't stall the queue
+    std::vector<Decoded> ready;
+    bool spritesPending = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+        size_t bytes = 0;
+        while (!decoded.empty() && (ready.empty() || bytes < uploadBudget)) {
+            Decoded& item = decoded.front();
+            if (item.kind == AssetKind::SPRITE) {
+                bytes += DecodedBytes(item.image);
+                spritesInFlight--;
+            } else {
+                bytes += DecodedBytes(item.wave);
+                soundsInFlight--;
+            }
+            ready.push_back(std::move(item));
+            decoded.pop_front();
+        }
+        spritesPending = spritesInFlight > 0;
+    }
+
+    for (Decoded& item : ready) {
+        if (item.kind == AssetKind::SPRITE) {
+            // A sprite requested again replaces the old image
+            auto existing = std::find_if(atlasImages.begin(), atlasImages.end(),
+                [&item](const std::pair<std::string, Image>& entry) { return entry.first == item.name; });
+            if (existing != atlasImages.end()) {
+                UnloadImage(existing->second);
+                existing->second = item.image;
+            } else {
+                atlasImages.emplace_back(item.name, item.image);
+            }
+            atlasDirty = true;
+            continue;
+        }
+
+        // Without an audio device the game runs silent
+        if (IsAudioDeviceReady()) {
+            auto existing = sounds.find(item.name);
+            if (existing != sounds.end()) UnloadSound(existing->second);
+            sounds[item.name] = LoadSoundFromWave(item.wave);
+        }
+        UnloadWave(item.wave);
+    }
+
+    // One upload once the last requested sprite is in, instead of one per file
+    if (atlasDirty && !spritesPending) {
+        BuildAtlas();
+    }
+}
+
+void AssetManager::Unload() {
+    if (atlas.id != 0) {
+        UnloadTexture(atlas);
+        atlas = Texture2D();
+    }
+    sprites.clear();
+    atlasDirty = !atlasImages.empty();
+
+    for (auto& entry : sounds) {
+        UnloadSound(entry.second);
+    }
+    sounds.clear();
+}
+
+const Sprite* AssetManager::GetSprite(const std::string& name) const {
+    auto it = sprites.find(name);
+    return it != sprites.end() ? &it->second : nullptr;
+}
+
+const Sound* AssetManager::GetSound(const std::string& name) const {
+    auto it = sounds.find(name);
+    return it != sounds.end() ? &it->second : nullptr;
+}
+
+bool AssetManager::IsLoading() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return spritesInFlight > 0 || soundsInFlight > 0 || atlasDirty;
+}
+
+void AssetManager::LoaderLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (stopping) return;
+        Request request = std::move(requests.front());
+        requests.pop_front();
+        lock.unlock();
+
+        // raylib decodes on the CPU only, so this is safe off the main thread
+        Decoded item = { request.kind, request.name, Image(), Wave() };
+        bool loaded = false;
+        if (FileExists(request.path.c_str())) {
+            if (request.kind == AssetKind::SPRITE) {
+                item.image = LoadImage(request.path.c_str());
+                loaded = IsImageReady(item.image);
+            } else {
+                item.wave = LoadWave(request.path.c_str());
+                loaded = IsWaveReady(item.wave);
+            }
+            if (!loaded) std::fprintf(stderr, "Could not decode %s\n", request.path.c_str());
+        }
+
+        lock.lock();
+        if (loaded) {
+            decoded.push_back(std::move(item));
+        } else if (request.kind == AssetKind::SPRITE) {
+            spritesInFlight--;
+        } else {
+            soundsInFlight--;
+        }
+    }
+}
+
+void AssetManager::BuildAtlas() {
+    atlasDirty = false;
+
+    // Tallest first packs a skyline tightest
+    std::vector<size_t> order(atlasImages.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return atlasImages[a].second.height > atlasImages[b].second.height;
+    });
+
+    // Smallest power-of-two page that holds the white block and every sprite
+    int width = 256;
+    int height = 256;
+    AtlasPacker packer(width, height);
+    Rectangle white = {};
+    std::vector<Rectangle> placed(atlasImages.size());
+    for (;;) {
+        packer.Reset(width, height);
+        bool fits = packer.Pack(WHITE_BLOCK_SIZE, WHITE_BLOCK_SIZE, white);
+        for (size_t i = 0; fits && i < order.size(); ++i) {
+            const Image& image = atlasImages[order[i]].second;
+            fits = packer.Pack(image.width, image.height, placed[order[i]]);
+        }
+        if (fits) break;
+        if (width >= MAX_ATLAS_SIZE && height >= MAX_ATLAS_SIZE) {
+            std::fprintf(stderr, "Sprites don't fit in a %dx%d atlas\n", MAX_ATLAS_SIZE, MAX_ATLAS_SIZE);
+            return;
+        }
+        if (height < width) height *= 2;
+        else width *= 2;
+    }
+
+    Image page = GenImageColor(width, height, BLANK);
+    Image whiteBlock = GenImageColor(WHITE_BLOCK_SIZE, WHITE_BLOCK_SIZE, WHITE);
+    ImageDraw(&page, whiteBlock, { 0.0f, 0.0f, WHITE_BLOCK_SIZE, WHITE_BLOCK_SIZE }, white, WHITE);
+    UnloadImage(whiteBlock);
+    for (size_t i = 0; i < atlasImages.size(); ++i) {
+        const Image& image = atlasImages[i].second;
+        const Rectangle source = { 0.0f, 0.0f, static_cast<float>(image.width), static_cast<float>(image.height) };
+        ImageDraw(&page, image, source, placed[i], WHITE);
+    }
+
+    Texture2D texture = LoadTextureFromImage(page);
+    UnloadImage(page);
+    SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+
+    // Shapes sample the middle of the white block, clear of filtering bleed
+    SetShapesTexture(texture, { white.x + 1.0f, white.y + 1.0f, WHITE_BLOCK_SIZE - 2.0f, WHITE_BLOCK_SIZE - 2.0f });
+    if (atlas.id != 0) UnloadTexture(atlas);
+    atlas = texture;
+
+    sprites.clear();
+    for (size_t i = 0; i < atlasImages.size(); ++i) {
+        sprites[atlasImages[i].first] = { atlas, placed[i] };
+    }
+}
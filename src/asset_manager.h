@@ -0,0 +1,92 @@
+#ifndef ASSET_MANAGER_H
+#define ASSET_MANAGER_H
+
+#include "raylib.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A region of a texture to draw an entity with. Sprites face right (rotation 0).
+struct Sprite {
+    Texture2D texture;
+    Rectangle source;
+};
+
+// Streams textures and sounds in without stalling the frame. Files are decoded
+// on a loader thread; the GPU side only happens in Update, which the game loop
+// calls once per frame with a byte budget for uploads.
+//
+// All sprites share one atlas texture, packed on the CPU once every requested
+// image has decoded, together with a small white block that raylib's shape
+// functions are pointed at. Sprites, rectangles and circles then draw from the
+// same texture, so a frame's entities batch into few draw calls.
+//
+// Missing files are skipped; callers fall back to shapes when GetSprite
+// returns null.
+class AssetManager {
+public:
+    AssetManager();
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // Queue the game's sprites and sounds for loading
+    void LoadTextures();
+    void LoadSounds();
+    void RequestSprite(const std::string& name, const std::string& path);
+    void RequestSound(const std::string& name, const std::string& path);
+
+    // Main thread only, with the window open: uploads what finished decoding
+    // and rebuilds the atlas once no sprites are still on their way
+    void Update();
+    // Releases GPU and audio resources; call before closing the window
+    void Unload();
+
+    // Null until the asset has been uploaded
+    const Sprite* GetSprite(const std::string& name) const;
+    const Sound* GetSound(const std::string& name) const;
+    bool IsLoading() const;
+
+private:
+    enum class AssetKind { SPRITE, SOUND };
+
+    struct Request {
+        AssetKind kind;
+        std::string name;
+        std::string path;
+    };
+
+    struct Decoded {
+        AssetKind kind;
+        std::string name;
+        Image image;
+        Wave wave;
+    };
+
+    std::thread loader;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::deque<Request> requests; // Waiting for the loader thread
+    std::deque<Decoded> decoded;  // Waiting for the main thread
+    size_t spritesInFlight;       // Requested and not yet taken by Update
+    size_t soundsInFlight;
+
+    size_t uploadBudget;          // Bytes uploaded per Update, at least one asset
+    std::vector<std::pair<std::string, Image>> atlasImages; // CPU copies the atlas is built from
+    bool atlasDirty;
+    Texture2D atlas;
+    std::unordered_map<std::string, Sprite> sprites;
+    std::unordered_map<std::string, Sound> sounds;
+
+    void LoaderLoop();
+    void BuildAtlas();
+};
+
+#endif // ASSET_MANAGER_H
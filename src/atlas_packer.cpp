@@ -0,0 +1,97 @@
+#include "atlas_packer.h"
+#include <algorithm>
+
+AtlasPacker::AtlasPacker(int width, int height, int padding)
+    : width(width),
+      height(height),
+      padding(padding) {
+    Reset(width, height);
+}
+
+void AtlasPacker::Reset(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    skyline.assign(1, Segment{ 0, 0, width });
+}
+
+bool AtlasPacker::Pack(int rectWidth, int rectHeight, Rectangle& placed) {
+    const int paddedWidth = rectWidth + padding;
+    const int paddedHeight = rectHeight + padding;
+
+    // Lowest resting place, ties going to the narrowest segment to limit waste
+    size_t bestIndex = skyline.size();
+    int bestY = height;
+    int bestWidth = width + 1;
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        const int y = FitAt(i, paddedWidth, paddedHeight);
+        if (y >= 0 && (y < bestY || (y == bestY && skyline[i].width < bestWidth))) {
+            bestIndex = i;
+            bestY = y;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (bestIndex == skyline.size()) return false;
+
+    const int x = skyline[bestIndex].x;
+    placed = { static_cast<float>(x), static_cast<float>(bestY),
+               static_cast<float>(rectWidth), static_cast<float>(rectHeight) };
+
+    // Raise the skyline under the new rect and trim the segments it covers
+    const Segment raised = { x, bestY + paddedHeight, paddedWidth };
+    skyline.insert(skyline.begin() + bestIndex, raised);
+    for (size_t i = bestIndex + 1; i < skyline.size();) {
+        Segment& segment = skyline[i];
+        const int coveredUntil = raised.x + raised.width;
+        if (segment.x >= coveredUntil) break;
+        const int overlap = coveredUntil - segment.x;
+        if (overlap >= segment.width) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        segment.x += overlap;
+        segment.width -= overlap;
+        break;
+    }
+
+    // Merge neighbours left at the same height
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+    return true;
+}
+
+int AtlasPacker::GetWidth() const {
+    return width;
+}
+
+int AtlasPacker::GetHeight() const {
+    return height;
+}
+
+int AtlasPacker::GetUsedHeight() const {
+    int used = 0;
+    for (const Segment& segment : skyline) {
+        used = std::max(used, segment.y);
+    }
+    return used;
+}
+
+int AtlasPacker::FitAt(size_t index, int rectWidth, int rectHeight) const {
+    if (skyline[index].x + rectWidth > width) return -1;
+
+    // Rest on the highest segment the rect spans
+    int y = 0;
+    int remaining = rectWidth;
+    for (size_t i = index; remaining > 0; ++i) {
+        if (i == skyline.size()) return -1;
+        y = std::max(y, skyline[i].y);
+        if (y + rectHeight > height) return -1;
+        remaining -= skyline[i].width;
+    }
+    return y;
+}
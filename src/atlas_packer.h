@@ -0,0 +1,42 @@
+#ifndef ATLAS_PACKER_H
+#define ATLAS_PACKER_H
+
+#include "core_types.h"
+#include <vector>
+#include <cstddef>
+
+// Skyline bottom-left rectangle packer for building texture atlases on the
+// CPU. The skyline is the top edge of everything placed so far; each rect goes
+// where it ends up lowest (then leftmost), which packs sprites of mixed sizes
+// tightly without tracking free rectangles.
+class AtlasPacker {
+public:
+    // padding is left around every rect so filtering doesn't bleed neighbours in
+    AtlasPacker(int width, int height, int padding = 1);
+
+    void Reset(int width, int height);
+    // Returns false when the rect doesn't fit in what's left
+    bool Pack(int width, int height, Rectangle& placed);
+
+    int GetWidth() const;
+    int GetHeight() const;
+    // Lowest height that holds everything packed so far
+    int GetUsedHeight() const;
+
+private:
+    struct Segment {
+        int x;
+        int y;     // Top of the packed area over [x, x + width)
+        int width;
+    };
+
+    int width;
+    int height;
+    int padding;
+    std::vector<Segment> skyline;
+
+    // Height a rect would rest at if placed on segment index onwards, or -1
+    int FitAt(size_t index, int rectWidth, int rectHeight) const;
+};
+
+#endif // ATLAS_PACKER_H
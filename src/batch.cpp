@@ -0,0 +1,277 @@
+#include "simulation.h"
+#include "scripted_input.h"
+#include "job_system.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Batch runner for balancing: plays many complete games in parallel, one
+// independent Simulation per run, and reports per-run and aggregate stats.
+// Run i uses simulation seed (--seed + i), so any single run can be
+// reproduced with headless --seed.
+
+struct BatchOptions {
+    long long runs = 1000;
+    size_t threads = 0;            // 0 = every hardware thread
+    long long maxTicks = 60 * 600; // Ten minutes of game time per run
+    float deltaTime = 1.0f / 60.0f;
+    float worldWidth = 800.0f;
+    float worldHeight = 600.0f;
+    uint64_t seed = 1;
+    std::string input = "scripted";
+    std::string runsPath;          // Optional per-run CSV
+    std::string configPath;        // Compiled config, empty for the built-in one
+};
+
+enum class RunOutcome {
+    VICTORY,
+    GAME_OVER,
+    TIMEOUT
+};
+
+struct RunStats {
+    uint64_t seed;
+    RunOutcome outcome;
+    int score;
+    int wavesCleared;
+    long long ticks;
+    float gameTime;     // Seconds of play until the game ended
+    double ticksPerSecond;
+};
+
+// Mashes random buttons, changing them every few ticks
+class RandomInput {
+public:
+    explicit RandomInput(uint32_t seed) : state(seed ? seed : 1), heldButtons(0), holdTicks(0) {}
+
+    InputState Next(GameState gameState) {
+        InputState input;
+        if (gameState != GameState::PLAYING) {
+            input.buttons = INPUT_START;
+            return input;
+        }
+        if (holdTicks <= 0) {
+            heldButtons = static_cast<uint8_t>(NextRandom() & (INPUT_RIGHT | INPUT_LEFT | INPUT_UP | INPUT_DOWN | INPUT_ATTACK));
+            holdTicks = 1 + static_cast<int>(NextRandom() % 8);
+        }
+        holdTicks--;
+        input.buttons = heldButtons;
+        return input;
+    }
+
+private:
+    uint32_t state;
+    uint8_t heldButtons;
+    int holdTicks;
+
+    uint32_t NextRandom() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+static const char* GetOutcomeName(RunOutcome outcome) {
+    switch (outcome) {
+        case RunOutcome::VICTORY: return "victory";
+        case RunOutcome::GAME_OVER: return "game_over";
+        case RunOutcome::TIMEOUT: return "timeout";
+    }
+    return "unknown";
+}
+
+template <typename Input>
+static RunStats PlayGame(const BatchOptions& options, uint64_t seed, Input& input) {
+    using Clock = std::chrono::steady_clock;
+    Simulation simulation(options.worldWidth, options.worldHeight, 4096, seed);
+    if (!options.configPath.empty()) {
+        // Checked in main, and mapping is cheap enough to do per run
+        auto config = std::make_unique<ConfigManager>();
+        std::string error;
+        config->LoadFromFile(options.configPath, error);
+        simulation.SetConfig(std::move(config));
+    }
+
+    RunStats stats = { seed, RunOutcome::TIMEOUT, 0, 0, 0, 0.0f, 0.0 };
+    const Clock::time_point start = Clock::now();
+
+    // Start the game, then play until it ends or time runs out
+    bool started = false;
+    while (stats.ticks < options.maxTicks) {
+        simulation.Step(options.deltaTime, input.Next(simulation.GetState()));
+        stats.ticks++;
+
+        const GameState state = simulation.GetState();
+        if (state == GameState::PLAYING) {
+            started = true;
+        } else if (started && (state == GameState::GAME_OVER || state == GameState::VICTORY)) {
+            stats.outcome = state == GameState::VICTORY ? RunOutcome::VICTORY : RunOutcome::GAME_OVER;
+            break;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const Scenario& scenario = simulation.GetScenario();
+    stats.score = simulation.GetScore();
+    stats.wavesCleared = stats.outcome == RunOutcome::VICTORY ? scenario.maxWaves : scenario.currentWave;
+    stats.gameTime = simulation.GetGameTimer();
+    stats.ticksPerSecond = seconds > 0.0 ? stats.ticks / seconds : 0.0;
+    return stats;
+}
+
+static RunStats RunOne(const BatchOptions& options, size_t index) {
+    const uint64_t seed = options.seed + index;
+    // Input streams decorrelated from the simulation seed
+    const uint32_t inputSeed = static_cast<uint32_t>((seed * 0x9E3779B97F4A7C15ULL) >> 32);
+
+    if (options.input == "random") {
+        RandomInput input(inputSeed);
+        return PlayGame(options, seed, input);
+    }
+    ScriptedInput input(inputSeed);
+    return PlayGame(options, seed, input);
+}
+
+static void PrintUsage(const char* program) {
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --runs N          Games to play (default 1000)\n"
+        "  --threads N       Worker threads (default: all hardware threads)\n"
+        "  --max-ticks N     Steps before a game counts as a timeout (default 36000)\n"
+        "  --dt SECONDS      Step length in seconds (default 1/60)\n"
+        "  --world W H       World size (default 800 600)\n"
+        "  --seed N          Seed of the first run, run i uses N + i (default 1)\n"
+        "  --input KIND      scripted or random (default scripted)\n"
+        "  --runs-out PATH   Also write every run's stats as CSV\n"
+        "  --config PATH     Compiled config to balance (default: built in)\n",
+        program
+    );
+}
+
+static bool ParseOptions(int argc, char** argv, BatchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            options.runs = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            options.maxTicks = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--dt") == 0 && i + 1 < argc) {
+            options.deltaTime = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--world") == 0 && i + 2 < argc) {
+            options.worldWidth = static_cast<float>(std::atof(argv[++i]));
+            options.worldHeight = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            options.input = argv[++i];
+            if (options.input != "scripted" && options.input != "random") return false;
+        } else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            options.configPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--runs-out") == 0 && i + 1 < argc) {
+            options.runsPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return options.runs > 0 && options.maxTicks > 0 && options.deltaTime > 0.0f;
+}
+
+static bool WriteRuns(const std::string& path, const std::vector<RunStats>& runs) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fprintf(out, "seed,outcome,score,waves_cleared,ticks,game_time,ticks_per_second\n");
+    for (const RunStats& run : runs) {
+        std::fprintf(out, "%llu,%s,%d,%d,%lld,%.3f,%.0f\n", static_cast<unsigned long long>(run.seed),
+                     GetOutcomeName(run.outcome), run.score, run.wavesCleared, run.ticks, run.gameTime,
+                     run.ticksPerSecond);
+    }
+    return std::fclose(out) == 0;
+}
+
+static void PrintReport(const BatchOptions& options, const std::vector<RunStats>& runs,
+                        size_t threadCount, double wallSeconds) {
+    int outcomes[3] = {};
+    long long totalTicks = 0;
+    double scoreSum = 0.0;
+    double deathTimeSum = 0.0;
+    double runRateSum = 0.0;
+    std::vector<int> scores;
+    std::vector<int> wavesHistogram;
+    scores.reserve(runs.size());
+
+    for (const RunStats& run : runs) {
+        outcomes[static_cast<int>(run.outcome)]++;
+        totalTicks += run.ticks;
+        scoreSum += run.score;
+        runRateSum += run.ticksPerSecond;
+        if (run.outcome == RunOutcome::GAME_OVER) deathTimeSum += run.gameTime;
+        scores.push_back(run.score);
+        if (run.wavesCleared >= static_cast<int>(wavesHistogram.size())) wavesHistogram.resize(run.wavesCleared + 1);
+        wavesHistogram[run.wavesCleared]++;
+    }
+    std::sort(scores.begin(), scores.end());
+
+    const double runCount = static_cast<double>(runs.size());
+    std::printf("runs:               %zu (%s input, seeds %llu..%llu)\n", runs.size(), options.input.c_str(),
+                static_cast<unsigned long long>(options.seed),
+                static_cast<unsigned long long>(options.seed + runs.size() - 1));
+    std::printf("threads:            %zu\n", threadCount);
+    std::printf("wall time:          %.3f s\n", wallSeconds);
+    std::printf("total ticks:        %lld\n", totalTicks);
+    std::printf("ticks/second:       %.0f aggregate, %.0f per run\n",
+                wallSeconds > 0.0 ? totalTicks / wallSeconds : 0.0, runRateSum / runCount);
+    std::printf("victories:          %d (%.1f%%)\n", outcomes[0], 100.0 * outcomes[0] / runCount);
+    std::printf("game overs:         %d (%.1f%%)\n", outcomes[1], 100.0 * outcomes[1] / runCount);
+    std::printf("timeouts:           %d (%.1f%%)\n", outcomes[2], 100.0 * outcomes[2] / runCount);
+    std::printf("score:              mean %.1f, min %d, median %d, max %d\n", scoreSum / runCount,
+                scores.front(), scores[scores.size() / 2], scores.back());
+    if (outcomes[1] > 0) {
+        std::printf("time to death:      %.1f s mean\n", deathTimeSum / outcomes[1]);
+    }
+    for (size_t waves = 0; waves < wavesHistogram.size(); ++waves) {
+        std::printf("waves cleared %zu:    %d\n", waves, wavesHistogram[waves]);
+    }
+}
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (!options.configPath.empty()) {
+        ConfigManager config;
+        std::string error;
+        if (!config.LoadFromFile(options.configPath, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<RunStats> runs(static_cast<size_t>(options.runs));
+    JobSystem jobs(options.threads);
+
+    // One game per chunk; threads that finish short games steal the rest
+    const auto start = std::chrono::steady_clock::now();
+    jobs.ParallelFor(runs.size(), 1, [&options, &runs](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+            runs[index] = RunOne(options, index);
+        }
+    });
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PrintReport(options, runs, jobs.GetThreadCount(), wallSeconds);
+
+    if (!options.runsPath.empty() && !WriteRuns(options.runsPath, runs)) {
+        std::fprintf(stderr, "Could not write %s\n", options.runsPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,419 @@
+#include "simulation.h"
+#include "enemy_kernels.h"
+#include "job_system.h"
+#include "particles.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Microbenchmarks for the simulation hot paths, run over a range of enemy
+// counts. Results go to stdout (or --out) as JSON or CSV so runs on different
+// builds can be diffed by scripts.
+
+static const float stepLength = 1.0f / 60.0f;
+static JobSystem* benchJobs = nullptr; // Shared by every benchmark world
+
+struct BenchOptions {
+    std::vector<size_t> counts = { 10, 100, 1000, 10000, 100000, 1000000 };
+    std::string filter;
+    std::string format = "json";
+    std::string outputPath;
+    double minTime = 0.25; // Seconds of timed work per benchmark and count
+    size_t threads = 1;
+};
+
+struct BenchResult {
+    const char* name;
+    size_t enemies;
+    long long iterations;
+    double meanNs;
+    double minNs;
+};
+
+struct Benchmark {
+    const char* name;
+    // Untimed work before every timed call, may be null
+    void (*prepare)(Simulation& simulation, size_t count);
+    // The timed call
+    void (*run)(Simulation& simulation, size_t count);
+};
+
+// World sized for roughly one asteroid per 100x100 px (never smaller than the
+// game's 800x600), so query costs stay comparable across counts
+static std::unique_ptr<Simulation> MakeWorld(size_t count) {
+    const double area = std::max(800.0 * 600.0, static_cast<double>(count) * 100.0 * 100.0);
+    const float width = static_cast<float>(std::sqrt(area * 4.0 / 3.0));
+    const float height = static_cast<float>(area / width);
+
+    // Headroom for the fragments of the split benchmark's kills
+    auto simulation = std::make_unique<Simulation>(width, height, count + count / 16 + 64);
+    InputState start;
+    start.buttons = INPUT_START;
+    simulation->Step(stepLength, start);
+
+    simulation->GetEnemies().Clear();
+    simulation->SpawnEnemies(static_cast<int>(count));
+
+    // Let the field drift so enemies also sit near the player, where the
+    // spawner never places them
+    for (int i = 0; i < 30; ++i) {
+        simulation->GetEnemies().Update(stepLength, width, height);
+    }
+    return simulation;
+}
+
+static void TopUp(Simulation& simulation, size_t count) {
+    const size_t live = simulation.GetEnemies().Count();
+    if (live < count) {
+        simulation.SpawnEnemies(static_cast<int>(count - live));
+    }
+}
+
+// Collision passes sweep from the previous step's poses, so every timed
+// step starts like Simulation::Step does
+static void PrepareStep(Simulation& simulation, size_t count) {
+    TopUp(simulation, count);
+    simulation.SavePreviousState();
+}
+
+static void PrepareDrift(Simulation& simulation, size_t count) {
+    PrepareStep(simulation, count);
+    simulation.GetEnemies().Update(stepLength, simulation.GetWorldWidth(), simulation.GetWorldHeight());
+}
+
+static void PrepareAttack(Simulation& simulation, size_t count) {
+    PrepareDrift(simulation, count);
+    if (!simulation.GetPlayer().IsAttacking()) {
+        // One step with the attack held leaves the player attacking
+        InputState attack;
+        attack.buttons = INPUT_ATTACK;
+        simulation.HandlePlayingState(0.0f, attack);
+        TopUp(simulation, count);
+    }
+}
+
+static void PrepareKills(Simulation& simulation, size_t count) {
+    TopUp(simulation, count);
+    // Kill one enemy in a hundred (at least one)
+    EnemyStore& enemies = simulation.GetEnemies();
+    const size_t stride = std::max<size_t>(1, std::min<size_t>(100, enemies.Count()));
+    for (size_t i = 0; i < enemies.Count(); i += stride) {
+        enemies.OnHit(i, 1000);
+    }
+}
+
+// Back to the requested count, then kill one in a hundred like PrepareKills;
+// the default waves' rocks each split in two
+static void PrepareSplits(Simulation& simulation, size_t count) {
+    EnemyStore& enemies = simulation.GetEnemies();
+    while (enemies.Count() > count) {
+        enemies.Despawn(enemies.GetHandle(enemies.Count() - 1));
+    }
+    PrepareKills(simulation, count);
+}
+
+static void PrepareEmpty(Simulation& simulation, size_t) {
+    simulation.GetEnemies().Clear();
+}
+
+static void RunEnemyUpdate(Simulation& simulation, size_t) {
+    simulation.GetEnemies().Update(stepLength, simulation.GetWorldWidth(), simulation.GetWorldHeight(), benchJobs);
+}
+
+static void RunAttackCollisions(Simulation& simulation, size_t) {
+    simulation.CheckAttackCollisions();
+}
+
+static void RunPlayerCollisions(Simulation& simulation, size_t) {
+    simulation.CheckPlayerEnemyCollisions();
+}
+
+static void RunRemoveDead(Simulation& simulation, size_t) {
+    simulation.RemoveDeadEnemies();
+}
+
+static void RunSplitAsteroids(Simulation& simulation, size_t) {
+    simulation.RemoveDeadEnemies();
+    simulation.SpawnFragments();
+}
+
+static void RunSpawn(Simulation& simulation, size_t count) {
+    simulation.SpawnEnemies(static_cast<int>(count));
+}
+
+static void RunPlayingTick(Simulation& simulation, size_t) {
+    // Circle and pulse the attack every eighth tick, like an active player
+    static const uint8_t pattern[] = { INPUT_RIGHT, INPUT_DOWN, INPUT_LEFT, INPUT_UP };
+    static uint64_t tick = 0;
+    tick++;
+    InputState input;
+    input.buttons = pattern[(tick / 30) % 4];
+    if (tick % 8 == 0) input.buttons |= INPUT_ATTACK;
+    simulation.HandlePlayingState(stepLength, input);
+}
+
+// One buffer reused across iterations, as a rollback ring would
+static Snapshot benchSnapshot;
+
+static void RunSnapshotCapture(Simulation& simulation, size_t) {
+    simulation.SaveSnapshot(benchSnapshot);
+}
+
+static void PrepareSnapshot(Simulation& simulation, size_t count) {
+    TopUp(simulation, count);
+    simulation.SaveSnapshot(benchSnapshot);
+}
+
+static void RunSnapshotRestore(Simulation& simulation, size_t) {
+    simulation.LoadSnapshot(benchSnapshot);
+}
+
+// Every enemy as a candidate, swept against a circle the size of the attack
+static std::vector<uint32_t> benchCandidates;
+static std::vector<uint8_t> benchHits;
+
+static void PrepareNarrowPhase(Simulation& simulation, size_t count) {
+    PrepareDrift(simulation, count);
+    const size_t live = simulation.GetEnemies().Count();
+    benchCandidates.resize(live);
+    for (size_t i = 0; i < live; ++i) benchCandidates[i] = static_cast<uint32_t>(i);
+    benchHits.resize(live);
+}
+
+static void RunNarrowPhase(Simulation& simulation, size_t) {
+    const SweptCircle circle = { simulation.GetWorldWidth() / 2, simulation.GetWorldHeight() / 2, 3.0f, 2.0f, 75.0f };
+    simulation.GetEnemies().SweepAgainstCircle(benchCandidates.data(), benchCandidates.size(), circle, benchHits.data());
+}
+
+static void RunAsteroidCollisions(Simulation& simulation, size_t) {
+    simulation.GetEnemies().ResolveCollisions(simulation.GetWorldWidth(), simulation.GetWorldHeight(),
+                                              simulation.GetTickArena());
+}
+
+// Refills the ring with the same 5000 bullets every time, spread over the
+// world in every direction and one step into their flight
+static void PrepareProjectiles(Simulation& simulation, size_t) {
+    ProjectileStore& projectiles = simulation.GetProjectiles();
+    projectiles.Clear();
+    uint32_t state = 12345;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    };
+    for (int i = 0; i < 5000; ++i) {
+        const float angle = next() * 2.0f * PI;
+        projectiles.Fire(next() * simulation.GetWorldWidth(), next() * simulation.GetWorldHeight(),
+                         std::cos(angle) * 12.0f, std::sin(angle) * 12.0f, 1000.0f);
+    }
+    projectiles.Update(stepLength, simulation.GetWorldWidth(), simulation.GetWorldHeight());
+}
+
+static void PrepareProjectileCollisions(Simulation& simulation, size_t count) {
+    PrepareDrift(simulation, count);
+    PrepareProjectiles(simulation, count);
+}
+
+static void RunProjectileUpdate(Simulation& simulation, size_t) {
+    simulation.GetProjectiles().Update(stepLength, simulation.GetWorldWidth(), simulation.GetWorldHeight());
+}
+
+static void RunProjectileCollisions(Simulation& simulation, size_t) {
+    simulation.CheckProjectileCollisions();
+}
+
+// Every asteroid blowing up in the same frame: the whole chain's kill bursts
+// and one update. The budget caps it, so past a few hundred kills the cost
+// should stop growing with the count.
+static ParticleSystem benchParticles;
+
+static void PrepareChainExplosion(Simulation& simulation, size_t count) {
+    TopUp(simulation, count);
+    benchParticles.Clear();
+}
+
+static void RunChainExplosion(Simulation& simulation, size_t) {
+    const EnemyStore& enemies = simulation.GetEnemies();
+    for (size_t i = 0; i < enemies.Count(); ++i) {
+        const Rectangle bounds = enemies.GetRectangle(i);
+        const Vector2 speed = enemies.GetSpeed(i);
+        ParticleBurst burst;
+        burst.position = { bounds.x + bounds.width * 0.5f, bounds.y + bounds.height * 0.5f };
+        burst.velocity = { speed.x * 60.0f, speed.y * 60.0f };
+        burst.direction = 0.0f;
+        burst.spread = 2.0f * PI;
+        burst.count = static_cast<int>(bounds.width * 0.6f);
+        burst.speed = 180.0f;
+        burst.lifetime = 0.7f;
+        burst.size = 4.0f;
+        burst.color = enemies.GetColor(i);
+        benchParticles.Emit(burst);
+    }
+    benchParticles.Update(stepLength);
+}
+
+static const Benchmark benchmarks[] = {
+    { "enemy_update", nullptr, RunEnemyUpdate },
+    { "asteroid_collisions", PrepareDrift, RunAsteroidCollisions },
+    { "attack_collisions", PrepareAttack, RunAttackCollisions },
+    { "player_collisions", PrepareDrift, RunPlayerCollisions },
+    { "narrow_phase", PrepareNarrowPhase, RunNarrowPhase },
+    { "projectile_update", PrepareProjectiles, RunProjectileUpdate },
+    { "projectile_collisions", PrepareProjectileCollisions, RunProjectileCollisions },
+    { "remove_dead_enemies", PrepareKills, RunRemoveDead },
+    { "split_asteroids", PrepareSplits, RunSplitAsteroids },
+    { "chain_explosion", PrepareChainExplosion, RunChainExplosion },
+    { "spawn_enemies", PrepareEmpty, RunSpawn },
+    { "playing_tick", PrepareStep, RunPlayingTick },
+    { "snapshot_capture", TopUp, RunSnapshotCapture },
+    { "snapshot_restore", PrepareSnapshot, RunSnapshotRestore },
+};
+
+static BenchResult RunBenchmark(const Benchmark& benchmark, size_t count, double minTime) {
+    using Clock = std::chrono::steady_clock;
+    std::unique_ptr<Simulation> simulation = MakeWorld(count);
+    simulation->SetJobSystem(benchJobs);
+
+    BenchResult result = { benchmark.name, count, 0, 0.0, 1e300 };
+    double timedSeconds = 0.0;
+    const Clock::time_point wallStart = Clock::now();
+
+    // Stop once enough work was timed, or when setup dominates for too long
+    while ((timedSeconds < minTime || result.iterations < 3) &&
+           std::chrono::duration<double>(Clock::now() - wallStart).count() < minTime * 20.0) {
+        if (benchmark.prepare) benchmark.prepare(*simulation, count);
+
+        const Clock::time_point start = Clock::now();
+        benchmark.run(*simulation, count);
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        // Phases run outside Step leave their scratch in the tick arena
+        simulation->GetTickArena().Reset();
+
+        timedSeconds += elapsed;
+        result.minNs = std::min(result.minNs, elapsed * 1e9);
+        result.iterations++;
+    }
+    result.meanNs = timedSeconds * 1e9 / result.iterations;
+    return result;
+}
+
+static bool ParseCounts(const char* text, std::vector<size_t>& counts) {
+    counts.clear();
+    while (*text) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text || value == 0) return false;
+        counts.push_back(static_cast<size_t>(value));
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return !counts.empty();
+}
+
+static void PrintUsage(const char* program) {
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --counts A,B,...  Enemy counts to run (default 10,100,1000,10000,100000,1000000)\n"
+        "  --filter TEXT     Only run benchmarks whose name contains TEXT\n"
+        "  --format FMT      json or csv (default json)\n"
+        "  --out PATH        Write results to PATH instead of stdout\n"
+        "  --min-time SECS   Timed seconds per benchmark and count (default 0.25)\n"
+        "  --threads N       Job system threads, 0 = all (default 1)\n"
+        "  --kernel NAME     Kernel path: scalar, sse2 or avx2 (default: best)\n",
+        program
+    );
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--counts") == 0 && i + 1 < argc) {
+            if (!ParseCounts(argv[++i], options.counts)) return false;
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            options.format = argv[++i];
+            if (options.format != "json" && options.format != "csv") return false;
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            options.outputPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.minTime = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "scalar") == 0) SetKernelPath(KernelPath::SCALAR);
+            else if (std::strcmp(name, "sse2") == 0) SetKernelPath(KernelPath::SSE2);
+            else if (std::strcmp(name, "avx2") == 0) SetKernelPath(KernelPath::AVX2);
+            else return false;
+        } else {
+            return false;
+        }
+    }
+    return options.minTime > 0.0;
+}
+
+static void WriteCsv(std::FILE* out, const std::vector<BenchResult>& results) {
+    std::fprintf(out, "benchmark,enemies,iterations,mean_ns,min_ns,ns_per_enemy\n");
+    for (const BenchResult& result : results) {
+        std::fprintf(out, "%s,%zu,%lld,%.1f,%.1f,%.3f\n", result.name, result.enemies, result.iterations,
+                     result.meanNs, result.minNs, result.meanNs / result.enemies);
+    }
+}
+
+static void WriteJson(std::FILE* out, const std::vector<BenchResult>& results) {
+    std::fprintf(out, "{\n  \"kernel\": \"%s\",\n  \"threads\": %zu,\n  \"benchmarks\": [\n",
+                 GetKernelPathName(GetKernelPath()), benchJobs ? benchJobs->GetThreadCount() : 1);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        std::fprintf(out,
+            "    {\"name\": \"%s\", \"enemies\": %zu, \"iterations\": %lld, "
+            "\"mean_ns\": %.1f, \"min_ns\": %.1f, \"ns_per_enemy\": %.3f}%s\n",
+            result.name, result.enemies, result.iterations, result.meanNs, result.minNs,
+            result.meanNs / result.enemies, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    JobSystem jobs(options.threads);
+    benchJobs = &jobs;
+
+    std::vector<BenchResult> results;
+    for (const Benchmark& benchmark : benchmarks) {
+        if (!options.filter.empty() && std::strstr(benchmark.name, options.filter.c_str()) == nullptr) {
+            continue;
+        }
+        for (size_t count : options.counts) {
+            results.push_back(RunBenchmark(benchmark, count, options.minTime));
+            const BenchResult& result = results.back();
+            std::fprintf(stderr, "%-20s %8zu enemies  %12.1f ns  (%lld iterations)\n",
+                         result.name, result.enemies, result.meanNs, result.iterations);
+        }
+    }
+
+    std::FILE* out = stdout;
+    if (!options.outputPath.empty()) {
+        out = std::fopen(options.outputPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Could not open %s\n", options.outputPath.c_str());
+            return 1;
+        }
+    }
+    if (options.format == "csv") {
+        WriteCsv(out, results);
+    } else {
+        WriteJson(out, results);
+    }
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "collision.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Earliest t in [0, 1] where a moving point is strictly within `radius` of
+// `center`, by solving |offset + move * t| = radius
+bool SweepPointCircle(Vector2 start, Vector2 move, Vector2 center, float radius, float& timeOfImpact) {
+    const float offsetX = start.x - center.x;
+    const float offsetY = start.y - center.y;
+    const float c = offsetX * offsetX + offsetY * offsetY - radius * radius;
+    if (c < 0.0f) {
+        timeOfImpact = 0.0f;
+        return true;
+    }
+
+    const float a = move.x * move.x + move.y * move.y;
+    const float b = offsetX * move.x + offsetY * move.y;
+    if (a <= 0.0f || b >= 0.0f) return false; // Not moving, or moving away
+
+    // A double root only grazes the circle
+    const float discriminant = b * b - a * c;
+    if (discriminant <= 0.0f) return false;
+
+    const float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.0f) return false;
+    timeOfImpact = t;
+    return true;
+}
+
+// Earliest t in [0, 1] where a moving point is strictly inside the box
+bool SweepPointBox(Vector2 start, Vector2 move, float minX, float minY, float maxX, float maxY,
+                   float& timeOfImpact) {
+    float enter = 0.0f;
+    float exit = 1.0f;
+    const float starts[2] = { start.x, start.y };
+    const float moves[2] = { move.x, move.y };
+    const float mins[2] = { minX, minY };
+    const float maxs[2] = { maxX, maxY };
+    for (int axis = 0; axis < 2; ++axis) {
+        if (moves[axis] == 0.0f) {
+            if (starts[axis] <= mins[axis] || starts[axis] >= maxs[axis]) return false;
+            continue;
+        }
+        const float inverse = 1.0f / moves[axis];
+        float near = (mins[axis] - starts[axis]) * inverse;
+        float far = (maxs[axis] - starts[axis]) * inverse;
+        if (near > far) std::swap(near, far);
+        enter = std::max(enter, near);
+        exit = std::min(exit, far);
+        if (enter >= exit) return false;
+    }
+    timeOfImpact = enter;
+    return true;
+}
+
+}
+
+bool SweepCircles(Vector2 startA, Vector2 moveA, float radiusA,
+                  Vector2 startB, Vector2 moveB, float radiusB, float& timeOfImpact) {
+    // Work in A's frame: B moves relative to a fixed A, and the two circles
+    // touch when B's center is radiusA + radiusB from A's
+    const Vector2 relativeMove = { moveB.x - moveA.x, moveB.y - moveA.y };
+    return SweepPointCircle(startB, relativeMove, startA, radiusA + radiusB, timeOfImpact);
+}
+
+bool SweepCircleRect(Vector2 start, Vector2 move, float radius, const Rectangle& bounds, float& timeOfImpact) {
+    // The circle touches the bounds when its center enters the bounds grown by
+    // the radius with rounded corners: two boxes, each grown along one axis,
+    // plus a circle at every corner. The earliest entry into any of them wins.
+    const float minX = bounds.x;
+    const float minY = bounds.y;
+    const float maxX = bounds.x + bounds.width;
+    const float maxY = bounds.y + bounds.height;
+
+    bool hit = false;
+    float earliest = 1.0f;
+    float t = 0.0f;
+    if (SweepPointBox(start, move, minX - radius, minY, maxX + radius, maxY, t) && t <= earliest) {
+        earliest = t;
+        hit = true;
+    }
+    if (SweepPointBox(start, move, minX, minY - radius, maxX, maxY + radius, t) && t <= earliest) {
+        earliest = t;
+        hit = true;
+    }
+    const Vector2 corners[4] = { { minX, minY }, { maxX, minY }, { minX, maxY }, { maxX, maxY } };
+    for (const Vector2& corner : corners) {
+        if (SweepPointCircle(start, move, corner, radius, t) && t <= earliest) {
+            earliest = t;
+            hit = true;
+        }
+    }
+    if (hit) timeOfImpact = earliest;
+    return hit;
+}
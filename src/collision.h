@@ -0,0 +1,23 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "core_types.h"
+
+// Continuous (swept) collision tests. Each body moves in a straight line over
+// the step, from `start` by `move`; the tests report the earliest time of
+// impact as a fraction of the step in [0, 1], 0 when the bodies already
+// overlap at the start. Fast bodies can't pass through each other between
+// steps, so results hold up at low tick rates and long frames.
+//
+// Like CheckCollisionRecs, only real overlap counts; bodies that just touch
+// or graze each other don't collide.
+
+// Two moving circles
+bool SweepCircles(Vector2 startA, Vector2 moveA, float radiusA,
+                  Vector2 startB, Vector2 moveB, float radiusB, float& timeOfImpact);
+
+// A moving circle against fixed bounds. For moving bounds, pass the circle's
+// motion relative to them.
+bool SweepCircleRect(Vector2 start, Vector2 move, float radius, const Rectangle& bounds, float& timeOfImpact);
+
+#endif // COLLISION_H
@@ -0,0 +1,81 @@
+#include "config_format.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Offline compiler from the text config format to the binary blob the game
+// maps at startup. With --watch it keeps recompiling whenever the text
+// changes, so a running game (which watches the blob) follows every edit.
+
+static bool Compile(const std::string& inputPath, const std::string& outputPath) {
+    std::ifstream input(inputPath, std::ios::binary);
+    if (!input) {
+        std::fprintf(stderr, "Could not read %s\n", inputPath.c_str());
+        return false;
+    }
+    std::stringstream text;
+    text << input.rdbuf();
+
+    std::vector<uint8_t> blob;
+    std::string error;
+    if (!CompileConfig(text.str(), blob, error)) {
+        std::fprintf(stderr, "%s: %s\n", inputPath.c_str(), error.c_str());
+        return false;
+    }
+
+    // Write beside the target and rename over it, so readers only ever see a
+    // complete file
+    const std::string temporaryPath = outputPath + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+        if (!output) {
+            std::fprintf(stderr, "Could not write %s\n", temporaryPath.c_str());
+            return false;
+        }
+    }
+    std::error_code renameError;
+    std::filesystem::rename(temporaryPath, outputPath, renameError);
+    if (renameError) {
+        std::fprintf(stderr, "Could not replace %s: %s\n", outputPath.c_str(), renameError.message().c_str());
+        return false;
+    }
+
+    std::printf("Compiled %s -> %s (%zu bytes)\n", inputPath.c_str(), outputPath.c_str(), blob.size());
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool watch = false;
+    int first = 1;
+    if (argc > 1 && std::strcmp(argv[1], "--watch") == 0) {
+        watch = true;
+        first = 2;
+    }
+    if (argc - first != 2) {
+        std::fprintf(stderr, "Usage: %s [--watch] INPUT.cfg OUTPUT.bin\n", argv[0]);
+        return 1;
+    }
+    const std::string inputPath = argv[first];
+    const std::string outputPath = argv[first + 1];
+
+    bool compiled = Compile(inputPath, outputPath);
+    if (!watch) return compiled ? 0 : 1;
+
+    std::error_code error;
+    std::filesystem::file_time_type lastWrite = std::filesystem::last_write_time(inputPath, error);
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const std::filesystem::file_time_type write = std::filesystem::last_write_time(inputPath, error);
+        if (!error && write != lastWrite) {
+            lastWrite = write;
+            Compile(inputPath, outputPath);
+        }
+    }
+}
@@ -0,0 +1,275 @@
+#include "config_format.h"
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+static const char configMagic[4] = { 'A', 'S', 'T', 'C' };
+static const uint32_t maxWaveEnemies = 1u << 20;
+
+static uint32_t Checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool ParseColor(const std::string& value, uint8_t color[4]) {
+    int channels[4] = { 0, 0, 0, 255 };
+    int count = 0;
+    const char* text = value.c_str();
+    while (*text && count < 4) {
+        char* end = nullptr;
+        long channel = std::strtol(text, &end, 10);
+        if (end == text || channel < 0 || channel > 255) return false;
+        channels[count++] = static_cast<int>(channel);
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    if (*text || count < 3) return false;
+    for (int i = 0; i < 4; ++i) color[i] = static_cast<uint8_t>(channels[i]);
+    return true;
+}
+
+// A split chain longer than the archetype table goes round in a loop, and
+// destroying any rock on it would never stop spawning fragments
+static bool SplitChainsEnd(const ConfigEntityRecord* archetypes, uint32_t count) {
+    for (uint32_t start = 0; start < count; ++start) {
+        uint32_t archetype = start;
+        for (uint32_t depth = 0; archetypes[archetype].splitArchetype != CONFIG_NO_SPLIT; ++depth) {
+            if (depth == count) return false;
+            archetype = archetypes[archetype].splitArchetype;
+        }
+    }
+    return true;
+}
+
+// Reads size/speed/health/color/fragments fields into an entity record; the
+// split archetype is a name, resolved by the caller
+static bool ParseEntityField(const std::string& key, const std::string& value, ConfigEntityRecord& entity) {
+    char* end = nullptr;
+    if (key == "size") {
+        entity.size = std::strtof(value.c_str(), &end);
+        return *end == '\0' && entity.size > 0.0f;
+    }
+    if (key == "speed") {
+        entity.speed = std::strtof(value.c_str(), &end);
+        return *end == '\0';
+    }
+    if (key == "health") {
+        long health = std::strtol(value.c_str(), &end, 10);
+        entity.health = static_cast<int32_t>(health);
+        return *end == '\0' && health > 0 && health < 1000000;
+    }
+    if (key == "color") {
+        return ParseColor(value, entity.color);
+    }
+    if (key == "fragments") {
+        unsigned long count = std::strtoul(value.c_str(), &end, 10);
+        entity.fragmentCount = static_cast<uint32_t>(count);
+        return *end == '\0' && count <= CONFIG_MAX_FRAGMENTS;
+    }
+    return false;
+}
+
+bool CompileConfig(const std::string& text, std::vector<uint8_t>& blob, std::string& error) {
+    ConfigEntityRecord player = { 50.0f, 5.0f, 3, { 0, 121, 241, 255 }, CONFIG_NO_SPLIT, 0 };
+    bool hasPlayer = false;
+    std::vector<std::string> archetypeNames;
+    std::vector<ConfigEntityRecord> archetypes;
+    std::vector<std::string> splitNames; // Per archetype, empty when it doesn't split
+    std::vector<std::string> waveArchetypes;
+    std::vector<ConfigWaveRecord> waves;
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream tokens(line);
+        std::string kind;
+        if (!(tokens >> kind)) continue;
+
+        auto fail = [&error, lineNumber](const std::string& message) {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            return false;
+        };
+
+        ConfigEntityRecord entity = { 0.0f, 0.0f, 1, { 255, 255, 255, 255 }, CONFIG_NO_SPLIT, 0 };
+        ConfigWaveRecord wave = { 0, 0 };
+        std::string archetypeName;
+        std::string splitName;
+        if (kind == "archetype" && !(tokens >> archetypeName)) {
+            return fail("archetype needs a name");
+        }
+
+        std::string field;
+        while (tokens >> field) {
+            const size_t equals = field.find('=');
+            if (equals == std::string::npos) return fail("expected key=value, got '" + field + "'");
+            const std::string key = field.substr(0, equals);
+            const std::string value = field.substr(equals + 1);
+
+            if (kind == "archetype" && key == "split") {
+                if (value.empty()) return fail("split needs an archetype name");
+                splitName = value;
+            } else if (kind == "player" || kind == "archetype") {
+                if (!ParseEntityField(key, value, kind == "player" ? player : entity)) {
+                    return fail("bad " + kind + " field '" + field + "'");
+                }
+            } else if (kind == "wave") {
+                if (key == "archetype") {
+                    archetypeName = value;
+                } else if (key == "count") {
+                    char* end = nullptr;
+                    unsigned long count = std::strtoul(value.c_str(), &end, 10);
+                    if (*end != '\0' || count == 0 || count > maxWaveEnemies) return fail("bad wave count '" + value + "'");
+                    wave.enemyCount = static_cast<uint32_t>(count);
+                } else {
+                    return fail("unknown wave field '" + key + "'");
+                }
+            } else {
+                return fail("unknown record '" + kind + "'");
+            }
+        }
+
+        if (kind == "player") {
+            hasPlayer = true;
+        } else if (kind == "archetype") {
+            if (entity.size <= 0.0f) return fail("archetype '" + archetypeName + "' needs a size");
+            for (const std::string& name : archetypeNames) {
+                if (name == archetypeName) return fail("archetype '" + archetypeName + "' defined twice");
+            }
+            if (splitName.empty() != (entity.fragmentCount == 0)) {
+                return fail("archetype '" + archetypeName + "' needs both split= and fragments=");
+            }
+            archetypeNames.push_back(archetypeName);
+            archetypes.push_back(entity);
+            splitNames.push_back(splitName);
+        } else if (kind == "wave") {
+            if (archetypeName.empty() || wave.enemyCount == 0) return fail("wave needs archetype= and count=");
+            waveArchetypes.push_back(archetypeName);
+            waves.push_back(wave);
+        } else {
+            return fail("unknown record '" + kind + "'");
+        }
+    }
+
+    if (!hasPlayer) {
+        error = "no player record";
+        return false;
+    }
+    if (waves.empty()) {
+        error = "no waves";
+        return false;
+    }
+
+    // Waves and splits may name archetypes defined further down, so resolve
+    // at the end
+    auto findArchetype = [&archetypeNames](const std::string& name) {
+        size_t index = 0;
+        while (index < archetypeNames.size() && archetypeNames[index] != name) index++;
+        return index;
+    };
+    for (size_t i = 0; i < waves.size(); ++i) {
+        const size_t index = findArchetype(waveArchetypes[i]);
+        if (index == archetypeNames.size()) {
+            error = "wave " + std::to_string(i + 1) + " uses unknown archetype '" + waveArchetypes[i] + "'";
+            return false;
+        }
+        waves[i].archetype = static_cast<uint32_t>(index);
+    }
+    for (size_t i = 0; i < archetypes.size(); ++i) {
+        if (splitNames[i].empty()) continue;
+        const size_t index = findArchetype(splitNames[i]);
+        if (index == archetypeNames.size()) {
+            error = "archetype '" + archetypeNames[i] + "' splits into unknown archetype '" + splitNames[i] + "'";
+            return false;
+        }
+        archetypes[i].splitArchetype = static_cast<uint32_t>(index);
+    }
+    if (!SplitChainsEnd(archetypes.data(), static_cast<uint32_t>(archetypes.size()))) {
+        error = "archetypes split into each other in a loop";
+        return false;
+    }
+
+    ConfigBlobHeader header = {};
+    std::memcpy(header.magic, configMagic, sizeof(configMagic));
+    header.version = CONFIG_VERSION;
+    header.byteOrder = CONFIG_BYTE_ORDER;
+    header.archetypeCount = static_cast<uint32_t>(archetypes.size());
+    header.waveCount = static_cast<uint32_t>(waves.size());
+    header.player = player;
+    header.totalSize = static_cast<uint32_t>(sizeof(ConfigBlobHeader) + archetypes.size() * sizeof(ConfigEntityRecord) +
+                                             waves.size() * sizeof(ConfigWaveRecord));
+
+    blob.assign(header.totalSize, 0);
+    uint8_t* tables = blob.data() + sizeof(ConfigBlobHeader);
+    std::memcpy(tables, archetypes.data(), archetypes.size() * sizeof(ConfigEntityRecord));
+    std::memcpy(tables + archetypes.size() * sizeof(ConfigEntityRecord), waves.data(),
+                waves.size() * sizeof(ConfigWaveRecord));
+    header.checksum = Checksum(tables, blob.size() - sizeof(ConfigBlobHeader));
+    std::memcpy(blob.data(), &header, sizeof(header));
+    return true;
+}
+
+bool ValidateConfigBlob(const uint8_t* data, size_t size, std::string& error) {
+    if (size < sizeof(ConfigBlobHeader)) {
+        error = "file too small";
+        return false;
+    }
+    ConfigBlobHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, configMagic, sizeof(configMagic)) != 0) {
+        error = "not a compiled config";
+        return false;
+    }
+    if (header.version != CONFIG_VERSION || header.byteOrder != CONFIG_BYTE_ORDER) {
+        error = "compiled for another version or byte order; recompile it";
+        return false;
+    }
+    const uint64_t expectedSize = sizeof(ConfigBlobHeader) +
+                                  static_cast<uint64_t>(header.archetypeCount) * sizeof(ConfigEntityRecord) +
+                                  static_cast<uint64_t>(header.waveCount) * sizeof(ConfigWaveRecord);
+    if (header.totalSize != size || expectedSize != size) {
+        error = "size mismatch (truncated or partially written file?)";
+        return false;
+    }
+    if (header.archetypeCount == 0 || header.waveCount == 0) {
+        error = "no archetypes or waves";
+        return false;
+    }
+    if (Checksum(data + sizeof(ConfigBlobHeader), size - sizeof(ConfigBlobHeader)) != header.checksum) {
+        error = "checksum mismatch";
+        return false;
+    }
+
+    const uint8_t* waveTable = data + sizeof(ConfigBlobHeader) + header.archetypeCount * sizeof(ConfigEntityRecord);
+    for (uint32_t i = 0; i < header.waveCount; ++i) {
+        ConfigWaveRecord wave;
+        std::memcpy(&wave, waveTable + i * sizeof(ConfigWaveRecord), sizeof(wave));
+        if (wave.archetype >= header.archetypeCount) {
+            error = "wave references a missing archetype";
+            return false;
+        }
+    }
+
+    const ConfigEntityRecord* archetypes = reinterpret_cast<const ConfigEntityRecord*>(data + sizeof(ConfigBlobHeader));
+    for (uint32_t i = 0; i < header.archetypeCount; ++i) {
+        const ConfigEntityRecord& archetype = archetypes[i];
+        if ((archetype.splitArchetype != CONFIG_NO_SPLIT && archetype.splitArchetype >= header.archetypeCount) ||
+            archetype.fragmentCount > CONFIG_MAX_FRAGMENTS) {
+            error = "archetype splits into a missing archetype";
+            return false;
+        }
+    }
+    if (!SplitChainsEnd(archetypes, header.archetypeCount)) {
+        error = "archetypes split into each other in a loop";
+        return false;
+    }
+    return true;
+}
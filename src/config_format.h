@@ -0,0 +1,56 @@
+#ifndef CONFIG_FORMAT_H
+#define CONFIG_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Compiled game configuration. The blob is a header followed by the archetype
+// and wave tables, all fixed-size records with 4-byte alignment, so a mapped
+// file is used in place without any parsing. Produced by config_compiler from
+// the text format (see config/game.cfg).
+
+struct ConfigEntityRecord {
+    float size;
+    float speed;
+    int32_t health;
+    uint8_t color[4];        // RGBA
+    uint32_t splitArchetype; // Archetype the fragments use, or CONFIG_NO_SPLIT
+    uint32_t fragmentCount;  // Fragments spawned on destruction
+};
+
+struct ConfigWaveRecord {
+    uint32_t archetype;  // Index into the archetype table
+    uint32_t enemyCount;
+};
+
+struct ConfigBlobHeader {
+    char magic[4];       // "ASTC"
+    uint32_t version;
+    uint32_t byteOrder;  // CONFIG_BYTE_ORDER as written by the compiler
+    uint32_t totalSize;  // Header and tables, in bytes
+    uint32_t checksum;   // FNV-1a over everything after the header
+    uint32_t archetypeCount;
+    uint32_t waveCount;
+    uint32_t reserved;
+    ConfigEntityRecord player;
+    // ConfigEntityRecord archetypes[archetypeCount];
+    // ConfigWaveRecord waves[waveCount];
+};
+
+static const uint32_t CONFIG_VERSION = 2;
+static const uint32_t CONFIG_NO_SPLIT = UINT32_MAX;
+static const uint32_t CONFIG_MAX_FRAGMENTS = 16;
+static const uint32_t CONFIG_BYTE_ORDER = 0x01020304;
+
+// Turns config text into a blob. On failure returns false and sets error to a
+// message naming the offending line.
+bool CompileConfig(const std::string& text, std::vector<uint8_t>& blob, std::string& error);
+
+// Checks that data holds a complete, intact blob for this build (magic,
+// version, byte order, sizes, checksum, archetype references and split chains
+// that end)
+bool ValidateConfigBlob(const uint8_t* data, size_t size, std::string& error);
+
+#endif // CONFIG_FORMAT_H
@@ -0,0 +1,70 @@
+#include "config_watcher.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+ConfigWatcher::ConfigWatcher(const std::string& path)
+    : path(path),
+      stopping(false),
+      hasPending(false) {
+    thread = std::thread(&ConfigWatcher::WatchLoop, this);
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stopSignal.notify_all();
+    thread.join();
+}
+
+std::unique_ptr<ConfigManager> ConfigWatcher::TakeUpdate() {
+    // Cheap check first; the lock is only tried when there is something to take
+    if (!hasPending.load(std::memory_order_acquire)) return nullptr;
+
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) return nullptr;
+    hasPending.store(false, std::memory_order_relaxed);
+    return std::move(pending);
+}
+
+void ConfigWatcher::WatchLoop() {
+    namespace fs = std::filesystem;
+    const auto pollInterval = std::chrono::milliseconds(250);
+
+    // Only changes after startup count; the initial load is the caller's
+    std::error_code status;
+    fs::file_time_type lastWrite = fs::last_write_time(path, status);
+    uintmax_t lastSize = fs::file_size(path, status);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopSignal.wait_for(lock, pollInterval, [this] { return stopping; })) {
+        lock.unlock();
+
+        std::error_code error;
+        const fs::file_time_type write = fs::last_write_time(path, error);
+        const uintmax_t size = error ? 0 : fs::file_size(path, error);
+        std::unique_ptr<ConfigManager> config;
+        if (!error && (write != lastWrite || size != lastSize)) {
+            lastWrite = write;
+            lastSize = size;
+
+            // A half-written file fails validation; the next write retries
+            std::string message;
+            config = std::make_unique<ConfigManager>();
+            if (config->LoadFromFile(path, message)) {
+                std::fprintf(stderr, "Reloaded config %s\n", path.c_str());
+            } else {
+                std::fprintf(stderr, "Config reload failed: %s\n", message.c_str());
+                config.reset();
+            }
+        }
+
+        lock.lock();
+        if (config) {
+            pending = std::move(config);
+            hasPending.store(true, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include "simulation.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Watches a compiled config file from a background thread. When the file
+// changes it is mapped and validated there, and the result waits until the
+// game loop collects it between steps with TakeUpdate, which never blocks.
+class ConfigWatcher {
+public:
+    explicit ConfigWatcher(const std::string& path);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    // The newest config loaded since the last call, or null
+    std::unique_ptr<ConfigManager> TakeUpdate();
+
+private:
+    std::string path;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable stopSignal;
+    bool stopping;
+    std::unique_ptr<ConfigManager> pending;
+    std::atomic<bool> hasPending;
+
+    void WatchLoop();
+};
+
+#endif // CONFIG_WATCHER_H
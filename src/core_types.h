@@ -0,0 +1,45 @@
+#ifndef CORE_TYPES_H
+#define CORE_TYPES_H
+
+// The simulation core only needs raylib's plain value types (Vector2, Rectangle,
+// Color) and a few constants, never its functions. Headless-only builds have no
+// raylib at all, so they get layout-identical stand-ins instead.
+#ifdef ASTEROIDS_NO_RAYLIB
+
+#ifndef PI
+#define PI 3.14159265358979323846f
+#endif
+#ifndef DEG2RAD
+#define DEG2RAD (PI/180.0f)
+#endif
+
+struct Vector2 {
+    float x;
+    float y;
+};
+
+struct Rectangle {
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+struct Color {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+};
+
+// Same values as raylib's palette, limited to what the core uses
+#define RED        Color{ 230, 41, 55, 255 }
+#define MAROON     Color{ 190, 33, 55, 255 }
+#define DARKPURPLE Color{ 112, 31, 126, 255 }
+#define BLUE       Color{ 0, 121, 241, 255 }
+
+#else
+#include "raylib.h"
+#endif
+
+#endif // CORE_TYPES_H
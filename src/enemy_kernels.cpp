@@ -0,0 +1,360 @@
+#include "enemy_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ASTEROIDS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define ASTEROIDS_TARGET_AVX2
+#else
+#define ASTEROIDS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// This file is built with floating point contraction disabled (see
+// CMakeLists.txt) so no path gets a fused multiply-add the others lack.
+
+static void IntegrateScalar(float* x, float* y, float* speedX, float* speedY, const float* size,
+                            size_t begin, size_t end, float deltaTime, float worldWidth, float worldHeight) {
+    for (size_t i = begin; i < end; ++i) {
+        float ex = x[i];
+        float ey = y[i];
+        float sx = speedX[i];
+        float sy = speedY[i];
+        const float s = size[i];
+
+        // Update position, scaled by deltaTime for consistent movement
+        ex += sx * deltaTime * 60.0f;
+        ey += sy * deltaTime * 60.0f;
+
+        // Bounce off world edges, reflecting the part of the move past the
+        // edge so the path doesn't depend on the step length. The clamp only
+        // matters for moves longer than the world.
+        if (ex <= 0 || ex + s >= worldWidth) {
+            sx = -sx;
+            const float edge = worldWidth - s;
+            ex = ex <= 0 ? 0.0f - ex : (edge + edge) - ex;
+            ex = std::min(std::max(ex, 0.0f), edge);
+        }
+
+        if (ey <= 0 || ey + s >= worldHeight) {
+            sy = -sy;
+            const float edge = worldHeight - s;
+            ey = ey <= 0 ? 0.0f - ey : (edge + edge) - ey;
+            ey = std::min(std::max(ey, 0.0f), edge);
+        }
+
+        x[i] = ex;
+        y[i] = ey;
+        speedX[i] = sx;
+        speedY[i] = sy;
+    }
+}
+
+static size_t SweepScalar(const float* x, const float* y, const float* previousX, const float* previousY,
+                          const float* size, const uint32_t* candidates, size_t begin, size_t count,
+                          const SweptCircle& circle, uint8_t* hits) {
+    size_t hitCount = 0;
+    for (size_t k = begin; k < count; ++k) {
+        const uint32_t i = candidates[k];
+
+        // The enemy's circle relative to the other one, which stays put
+        const float radius = size[i] * 0.5f;
+        const float offsetX = (previousX[i] + radius) - circle.x;
+        const float offsetY = (previousY[i] + radius) - circle.y;
+        const float moveX = (x[i] - previousX[i]) - circle.moveX;
+        const float moveY = (y[i] - previousY[i]) - circle.moveY;
+        const float reach = circle.radius + radius;
+
+        // Overlapping at the start, or closing in and within reach by the end
+        const float c = offsetX * offsetX + offsetY * offsetY - reach * reach;
+        const float a = moveX * moveX + moveY * moveY;
+        const float b = offsetX * moveX + offsetY * moveY;
+        const float discriminant = b * b - a * c;
+        bool hit = c < 0.0f;
+        if (!hit && a > 0.0f && b < 0.0f && discriminant > 0.0f) {
+            hit = (-b - std::sqrt(discriminant)) / a <= 1.0f;
+        }
+        hits[k] = hit ? 1 : 0;
+        hitCount += hit ? 1 : 0;
+    }
+    return hitCount;
+}
+
+#ifdef ASTEROIDS_X86
+
+// One axis of the scalar logic above, four lanes at a time with masks in
+// place of branches
+static inline void BounceAxisSSE(__m128& position, __m128& speed, __m128 sizes, __m128 limit) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    __m128 hitLow = _mm_cmple_ps(position, zero);
+    __m128 hitHigh = _mm_cmpge_ps(_mm_add_ps(position, sizes), limit);
+    __m128 hit = _mm_or_ps(hitLow, hitHigh);
+    speed = _mm_xor_ps(speed, _mm_and_ps(hit, signBit));
+
+    // Max and min match std::max and std::min here, as -0 never reaches them
+    __m128 edge = _mm_sub_ps(limit, sizes);
+    __m128 mirrored = _mm_or_ps(_mm_and_ps(hitLow, _mm_sub_ps(zero, position)),
+                                _mm_andnot_ps(hitLow, _mm_sub_ps(_mm_add_ps(edge, edge), position)));
+    mirrored = _mm_min_ps(_mm_max_ps(mirrored, zero), edge);
+    position = _mm_or_ps(_mm_andnot_ps(hit, position), _mm_and_ps(hit, mirrored));
+}
+
+static void IntegrateSSE2(float* x, float* y, float* speedX, float* speedY, const float* size,
+                          size_t count, float deltaTime, float worldWidth, float worldHeight) {
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 sixty = _mm_set1_ps(60.0f);
+    const __m128 width = _mm_set1_ps(worldWidth);
+    const __m128 height = _mm_set1_ps(worldHeight);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 ex = _mm_loadu_ps(x + i);
+        __m128 ey = _mm_loadu_ps(y + i);
+        __m128 sx = _mm_loadu_ps(speedX + i);
+        __m128 sy = _mm_loadu_ps(speedY + i);
+        __m128 s = _mm_loadu_ps(size + i);
+
+        ex = _mm_add_ps(ex, _mm_mul_ps(_mm_mul_ps(sx, dt), sixty));
+        ey = _mm_add_ps(ey, _mm_mul_ps(_mm_mul_ps(sy, dt), sixty));
+        BounceAxisSSE(ex, sx, s, width);
+        BounceAxisSSE(ey, sy, s, height);
+
+        _mm_storeu_ps(x + i, ex);
+        _mm_storeu_ps(y + i, ey);
+        _mm_storeu_ps(speedX + i, sx);
+        _mm_storeu_ps(speedY + i, sy);
+    }
+    IntegrateScalar(x, y, speedX, speedY, size, i, count, deltaTime, worldWidth, worldHeight);
+}
+
+ASTEROIDS_TARGET_AVX2
+static inline void BounceAxisAVX2(__m256& position, __m256& speed, __m256 sizes, __m256 limit) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    __m256 hitLow = _mm256_cmp_ps(position, zero, _CMP_LE_OQ);
+    __m256 hitHigh = _mm256_cmp_ps(_mm256_add_ps(position, sizes), limit, _CMP_GE_OQ);
+    __m256 hit = _mm256_or_ps(hitLow, hitHigh);
+    speed = _mm256_xor_ps(speed, _mm256_and_ps(hit, signBit));
+
+    __m256 edge = _mm256_sub_ps(limit, sizes);
+    __m256 mirrored = _mm256_blendv_ps(_mm256_sub_ps(_mm256_add_ps(edge, edge), position),
+                                       _mm256_sub_ps(zero, position), hitLow);
+    mirrored = _mm256_min_ps(_mm256_max_ps(mirrored, zero), edge);
+    position = _mm256_blendv_ps(position, mirrored, hit);
+}
+
+ASTEROIDS_TARGET_AVX2
+static void IntegrateAVX2(float* x, float* y, float* speedX, float* speedY, const float* size,
+                          size_t count, float deltaTime, float worldWidth, float worldHeight) {
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 sixty = _mm256_set1_ps(60.0f);
+    const __m256 width = _mm256_set1_ps(worldWidth);
+    const __m256 height = _mm256_set1_ps(worldHeight);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 ex = _mm256_loadu_ps(x + i);
+        __m256 ey = _mm256_loadu_ps(y + i);
+        __m256 sx = _mm256_loadu_ps(speedX + i);
+        __m256 sy = _mm256_loadu_ps(speedY + i);
+        __m256 s = _mm256_loadu_ps(size + i);
+
+        ex = _mm256_add_ps(ex, _mm256_mul_ps(_mm256_mul_ps(sx, dt), sixty));
+        ey = _mm256_add_ps(ey, _mm256_mul_ps(_mm256_mul_ps(sy, dt), sixty));
+        BounceAxisAVX2(ex, sx, s, width);
+        BounceAxisAVX2(ey, sy, s, height);
+
+        _mm256_storeu_ps(x + i, ex);
+        _mm256_storeu_ps(y + i, ey);
+        _mm256_storeu_ps(speedX + i, sx);
+        _mm256_storeu_ps(speedY + i, sy);
+    }
+    IntegrateScalar(x, y, speedX, speedY, size, i, count, deltaTime, worldWidth, worldHeight);
+}
+
+// The scalar sweep test on four lanes; every lane is computed and the
+// failing ones masked off, so NaNs from lanes that miss never matter
+static inline __m128 SweepLanesSSE(__m128 ex, __m128 ey, __m128 px, __m128 py, __m128 s, const SweptCircle& circle) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    const __m128 radius = _mm_mul_ps(s, _mm_set1_ps(0.5f));
+    const __m128 offsetX = _mm_sub_ps(_mm_add_ps(px, radius), _mm_set1_ps(circle.x));
+    const __m128 offsetY = _mm_sub_ps(_mm_add_ps(py, radius), _mm_set1_ps(circle.y));
+    const __m128 moveX = _mm_sub_ps(_mm_sub_ps(ex, px), _mm_set1_ps(circle.moveX));
+    const __m128 moveY = _mm_sub_ps(_mm_sub_ps(ey, py), _mm_set1_ps(circle.moveY));
+    const __m128 reach = _mm_add_ps(_mm_set1_ps(circle.radius), radius);
+
+    const __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY)),
+                                _mm_mul_ps(reach, reach));
+    const __m128 a = _mm_add_ps(_mm_mul_ps(moveX, moveX), _mm_mul_ps(moveY, moveY));
+    const __m128 b = _mm_add_ps(_mm_mul_ps(offsetX, moveX), _mm_mul_ps(offsetY, moveY));
+    const __m128 discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+    const __m128 t = _mm_div_ps(_mm_sub_ps(_mm_xor_ps(b, signBit), _mm_sqrt_ps(discriminant)), a);
+
+    const __m128 closing = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(a, zero), _mm_cmplt_ps(b, zero)),
+                                      _mm_and_ps(_mm_cmpgt_ps(discriminant, zero), _mm_cmple_ps(t, _mm_set1_ps(1.0f))));
+    return _mm_or_ps(_mm_cmplt_ps(c, zero), closing);
+}
+
+static size_t SweepSSE2(const float* x, const float* y, const float* previousX, const float* previousY,
+                        const float* size, const uint32_t* candidates, size_t count,
+                        const SweptCircle& circle, uint8_t* hits) {
+    size_t hitCount = 0;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        // No gather before AVX2, so lanes are loaded one by one
+        alignas(16) float lanes[5][4];
+        for (int lane = 0; lane < 4; ++lane) {
+            const uint32_t i = candidates[k + lane];
+            lanes[0][lane] = x[i];
+            lanes[1][lane] = y[i];
+            lanes[2][lane] = previousX[i];
+            lanes[3][lane] = previousY[i];
+            lanes[4][lane] = size[i];
+        }
+        const __m128 hit = SweepLanesSSE(_mm_load_ps(lanes[0]), _mm_load_ps(lanes[1]), _mm_load_ps(lanes[2]),
+                                         _mm_load_ps(lanes[3]), _mm_load_ps(lanes[4]), circle);
+        const int mask = _mm_movemask_ps(hit);
+        for (int lane = 0; lane < 4; ++lane) {
+            hits[k + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+            hitCount += hits[k + lane];
+        }
+    }
+    return hitCount + SweepScalar(x, y, previousX, previousY, size, candidates, k, count, circle, hits);
+}
+
+ASTEROIDS_TARGET_AVX2
+static size_t SweepAVX2(const float* x, const float* y, const float* previousX, const float* previousY,
+                        const float* size, const uint32_t* candidates, size_t count,
+                        const SweptCircle& circle, uint8_t* hits) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 circleX = _mm256_set1_ps(circle.x);
+    const __m256 circleY = _mm256_set1_ps(circle.y);
+    const __m256 circleMoveX = _mm256_set1_ps(circle.moveX);
+    const __m256 circleMoveY = _mm256_set1_ps(circle.moveY);
+    const __m256 circleRadius = _mm256_set1_ps(circle.radius);
+
+    size_t hitCount = 0;
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(candidates + k));
+        const __m256 ex = _mm256_i32gather_ps(x, index, 4);
+        const __m256 ey = _mm256_i32gather_ps(y, index, 4);
+        const __m256 px = _mm256_i32gather_ps(previousX, index, 4);
+        const __m256 py = _mm256_i32gather_ps(previousY, index, 4);
+        const __m256 s = _mm256_i32gather_ps(size, index, 4);
+
+        const __m256 radius = _mm256_mul_ps(s, half);
+        const __m256 offsetX = _mm256_sub_ps(_mm256_add_ps(px, radius), circleX);
+        const __m256 offsetY = _mm256_sub_ps(_mm256_add_ps(py, radius), circleY);
+        const __m256 moveX = _mm256_sub_ps(_mm256_sub_ps(ex, px), circleMoveX);
+        const __m256 moveY = _mm256_sub_ps(_mm256_sub_ps(ey, py), circleMoveY);
+        const __m256 reach = _mm256_add_ps(circleRadius, radius);
+
+        const __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(offsetX, offsetX), _mm256_mul_ps(offsetY, offsetY)),
+                                       _mm256_mul_ps(reach, reach));
+        const __m256 a = _mm256_add_ps(_mm256_mul_ps(moveX, moveX), _mm256_mul_ps(moveY, moveY));
+        const __m256 b = _mm256_add_ps(_mm256_mul_ps(offsetX, moveX), _mm256_mul_ps(offsetY, moveY));
+        const __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+        const __m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_xor_ps(b, signBit), _mm256_sqrt_ps(discriminant)), a);
+
+        const __m256 closing = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(a, zero, _CMP_GT_OQ), _mm256_cmp_ps(b, zero, _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(discriminant, zero, _CMP_GT_OQ), _mm256_cmp_ps(t, one, _CMP_LE_OQ)));
+        const __m256 hit = _mm256_or_ps(_mm256_cmp_ps(c, zero, _CMP_LT_OQ), closing);
+
+        const int mask = _mm256_movemask_ps(hit);
+        for (int lane = 0; lane < 8; ++lane) {
+            hits[k + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+            hitCount += hits[k + lane];
+        }
+    }
+    return hitCount + SweepScalar(x, y, previousX, previousY, size, candidates, k, count, circle, hits);
+}
+
+static bool CpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // ASTEROIDS_X86
+
+KernelPath GetBestKernelPath() {
+#ifdef ASTEROIDS_X86
+    static const KernelPath best = CpuSupportsAVX2() ? KernelPath::AVX2 : KernelPath::SSE2;
+    return best;
+#else
+    return KernelPath::SCALAR;
+#endif
+}
+
+static KernelPath activePath = GetBestKernelPath();
+
+KernelPath GetKernelPath() {
+    return activePath;
+}
+
+void SetKernelPath(KernelPath path) {
+    activePath = static_cast<int>(path) <= static_cast<int>(GetBestKernelPath()) ? path : GetBestKernelPath();
+}
+
+const char* GetKernelPathName(KernelPath path) {
+    switch (path) {
+        case KernelPath::SCALAR: return "scalar";
+        case KernelPath::SSE2: return "sse2";
+        case KernelPath::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+void IntegrateEnemies(float* x, float* y, float* speedX, float* speedY, const float* size,
+                      size_t count, float deltaTime, float worldWidth, float worldHeight) {
+    switch (activePath) {
+#ifdef ASTEROIDS_X86
+        case KernelPath::AVX2:
+            IntegrateAVX2(x, y, speedX, speedY, size, count, deltaTime, worldWidth, worldHeight);
+            return;
+        case KernelPath::SSE2:
+            IntegrateSSE2(x, y, speedX, speedY, size, count, deltaTime, worldWidth, worldHeight);
+            return;
+#endif
+        default:
+            IntegrateScalar(x, y, speedX, speedY, size, 0, count, deltaTime, worldWidth, worldHeight);
+            return;
+    }
+}
+
+size_t SweepEnemiesAgainstCircle(const float* x, const float* y, const float* previousX, const float* previousY,
+                                 const float* size, const uint32_t* candidates, size_t count,
+                                 const SweptCircle& circle, uint8_t* hits) {
+    switch (activePath) {
+#ifdef ASTEROIDS_X86
+        case KernelPath::AVX2:
+            return SweepAVX2(x, y, previousX, previousY, size, candidates, count, circle, hits);
+        case KernelPath::SSE2:
+            return SweepSSE2(x, y, previousX, previousY, size, candidates, count, circle, hits);
+#endif
+        default:
+            return SweepScalar(x, y, previousX, previousY, size, candidates, 0, count, circle, hits);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef ENEMY_KERNELS_H
+#define ENEMY_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Instruction sets the batch kernels can run on
+enum class KernelPath {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Advances every enemy by one step and reflects velocities at the world edges.
+// Arrays are the EnemyStore columns (top-left corner, speed, size). All paths
+// perform the same float operations in the same order, so they produce
+// bit-identical results.
+void IntegrateEnemies(float* x, float* y, float* speedX, float* speedY, const float* size,
+                      size_t count, float deltaTime, float worldWidth, float worldHeight);
+
+// A circle moving in a straight line over one step
+struct SweptCircle {
+    float x;      // Center at the start of the step
+    float y;
+    float moveX;  // Distance moved over the step
+    float moveY;
+    float radius;
+};
+
+// Batched swept narrow phase. Each enemy named in `candidates` (from any
+// broadphase) is the circle inscribed in its box, moving from its previous to
+// its current position. hits[k] is set to 1 if candidate k comes strictly
+// within reach of `circle` during the step, else 0; returns the number of
+// hits. Agrees exactly with SweepCircles in collision.h, on every path.
+size_t SweepEnemiesAgainstCircle(const float* x, const float* y, const float* previousX, const float* previousY,
+                                 const float* size, const uint32_t* candidates, size_t count,
+                                 const SweptCircle& circle, uint8_t* hits);
+
+// Best path this CPU supports, detected once
+KernelPath GetBestKernelPath();
+// Path the kernels currently use
+KernelPath GetKernelPath();
+// Forces a path (falls back to the best supported one if unavailable)
+void SetKernelPath(KernelPath path);
+const char* GetKernelPathName(KernelPath path);
+
+#endif // ENEMY_KERNELS_H
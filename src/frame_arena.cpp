@@ -0,0 +1,77 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+
+FrameArena::FrameArena(const char* name, size_t capacity)
+    : name(name),
+      block(new unsigned char[capacity]),
+      capacity(capacity),
+      used(0),
+      spilled(0),
+      highWater(0) {}
+
+FrameArena::~FrameArena() {
+#ifndef NDEBUG
+    std::fprintf(stderr, "frame arena '%s': high-water %zu of %zu bytes\n", name,
+                 std::max(highWater, used + spilled), capacity);
+#endif
+}
+
+void* FrameArena::Allocate(size_t bytes, size_t alignment) {
+    assert(alignment <= alignof(std::max_align_t) && (alignment & (alignment - 1)) == 0);
+
+    // The block itself is aligned for any type, so aligning the offset is enough
+    const size_t offset = (used + alignment - 1) & ~(alignment - 1);
+    if (offset + bytes <= capacity) {
+        used = offset + bytes;
+        return block.get() + offset;
+    }
+
+    spills.emplace_back(new unsigned char[std::max<size_t>(bytes, 1)]);
+    spilled += bytes;
+    return spills.back().get();
+}
+
+const char* FrameArena::Format(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int length = std::vsnprintf(nullptr, 0, format, args);
+    va_end(args);
+    if (length < 0) return "";
+
+    char* text = static_cast<char*>(Allocate(static_cast<size_t>(length) + 1, 1));
+    va_start(args, format);
+    std::vsnprintf(text, static_cast<size_t>(length) + 1, format, args);
+    va_end(args);
+    return text;
+}
+
+void FrameArena::Reset() {
+    highWater = std::max(highWater, used + spilled);
+    if (!spills.empty()) {
+        // Nothing is live any more, so the block can move. Doubling past the
+        // high-water mark leaves room for frames a little busier than this one.
+        spills.clear();
+        while (capacity < highWater) capacity = std::max<size_t>(capacity * 2, 1024);
+        block.reset(new unsigned char[capacity]);
+#ifndef NDEBUG
+        std::fprintf(stderr, "frame arena '%s': grew to %zu bytes (high-water %zu)\n", name, capacity, highWater);
+#endif
+    }
+    used = 0;
+    spilled = 0;
+}
+
+size_t FrameArena::GetUsed() const {
+    return used + spilled;
+}
+
+size_t FrameArena::GetCapacity() const {
+    return capacity;
+}
+
+size_t FrameArena::GetHighWater() const {
+    return highWater;
+}
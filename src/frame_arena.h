@@ -0,0 +1,78 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that only lives until the end of a tick or frame:
+// query candidates, hit lists, contact pairs, spawn positions, UI strings.
+// Allocating is a pointer bump and nothing is freed individually; Reset drops
+// everything at once.
+//
+// A frame that outgrows the block spills into heap blocks, and the next Reset
+// frees them and grows the block to the frame's high-water mark, so once the
+// arena has seen its largest frame it never touches the heap again. Debug
+// builds report each growth and the final high-water mark on stderr.
+class FrameArena {
+public:
+    // name labels the debug reports
+    explicit FrameArena(const char* name, size_t capacity = 64 * 1024);
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // alignment is a power of two up to alignof(std::max_align_t)
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    // printf into the arena; the text lives until the next Reset
+    const char* Format(const char* format, ...);
+    // Invalidates everything allocated since the last Reset
+    void Reset();
+
+    // Bytes handed out since the last Reset, spills included
+    size_t GetUsed() const;
+    size_t GetCapacity() const;
+    // Largest GetUsed at any Reset so far
+    size_t GetHighWater() const;
+
+private:
+    const char* name;
+    std::unique_ptr<unsigned char[]> block;
+    size_t capacity;
+    size_t used;       // Bytes of the block in use
+    size_t spilled;    // Bytes in spill blocks
+    size_t highWater;
+    std::vector<std::unique_ptr<unsigned char[]>> spills; // Freed by Reset
+};
+
+// STL allocator over a FrameArena. Deallocation is a no-op, so containers
+// using it must not outlive the arena's next Reset; reserving up front keeps
+// growth from leaving dead copies behind in the arena.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena& arena) : arena(&arena) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template<typename U> friend class ArenaAllocator;
+    FrameArena* arena;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // FRAME_ARENA_H
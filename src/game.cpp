@@ -1,11 +1,20 @@
 #include "game.h"
-#include <iostream>
-#include <random>
-#include <algorithm>
+#include "profiler.h"
+#include "alloc_tracker.h"
+#include "sim_thread.h"
+#include "rlgl.h"
 #include <cmath>
+#include <cstdio>
+#include <random>
 
 // Input Handler Implementation
-InputHandler::InputHandler() : attackPressed(false), pausePressed(false) {}
+InputHandler::InputHandler()
+    : attackPressed(false),
+      pausePressed(false),
+      startPressed(false),
+      recording(false),
+      playingBack(false),
+      playbackTick(0) {}
 
 bool InputHandler::IsMovingRight() const {
     return IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D);
@@ -27,219 +36,118 @@ bool InputHandler::IsAttacking() const {
     return attackPressed;
 }
 
+bool InputHandler::IsFiring() const {
+    return IsKeyDown(KEY_F) || IsKeyDown(KEY_LEFT_CONTROL);
+}
+
 bool InputHandler::IsPausePressed() const {
     return pausePressed;
 }
 
+bool InputHandler::IsStartPressed() const {
+    return startPressed;
+}
+
 void InputHandler::Update() {
-    attackPressed = IsKeyPressed(KEY_SPACE);
-    pausePressed = IsKeyPressed(KEY_P) || IsKeyPressed(KEY_ESCAPE);
+    // Presses are latched until a simulation step consumes them, so frames that
+    // run no step (fast displays) don't lose them
+    attackPressed = attackPressed || IsKeyPressed(KEY_SPACE);
+    pausePressed = pausePressed || IsKeyPressed(KEY_P) || IsKeyPressed(KEY_ESCAPE);
+    startPressed = startPressed || IsKeyPressed(KEY_ENTER);
+}
+
+void InputHandler::ConsumePresses() {
+    attackPressed = false;
+    pausePressed = false;
+    startPressed = false;
+}
+
+InputState InputHandler::GetState() const {
+    InputState state;
+    if (IsMovingRight()) state.buttons |= INPUT_RIGHT;
+    if (IsMovingLeft()) state.buttons |= INPUT_LEFT;
+    if (IsMovingUp()) state.buttons |= INPUT_UP;
+    if (IsMovingDown()) state.buttons |= INPUT_DOWN;
+    if (IsAttacking()) state.buttons |= INPUT_ATTACK;
+    if (IsFiring()) state.buttons |= INPUT_FIRE;
+    if (IsPausePressed()) state.buttons |= INPUT_PAUSE;
+    if (IsStartPressed()) state.buttons |= INPUT_START;
+    return state;
+}
+
+InputState InputHandler::NextStep(const InputState& live) {
+    InputState state;
+    if (playingBack && playbackTick < playbackLog.Size()) {
+        state = playbackLog.Get(playbackTick++);
+    } else {
+        playingBack = false;
+        state = live;
+    }
+    
+    if (recording) {
+        recordLog.Append(state);
+    }
+    return state;
 }
 
-// Config Manager Implementation
-ConfigManager::ConfigManager() {
-    LoadConfigs();
+void InputHandler::StartRecording(const InputLog& header) {
+    recordLog = header;
+    recordLog.Clear();
+    recording = true;
 }
 
-void ConfigManager::LoadConfigs() {
-    // Player config
-    playerConfig.size = 50.0f;
-    playerConfig.speed = 5.0f;
-    playerConfig.health = 3;
-    playerConfig.color = BLUE;
-    
-    // Enemy configs for different waves
-    enemyConfigs.resize(3); // For 3 waves of enemies
-    
-    // Wave 1 enemies
-    enemyConfigs[0].size = 50.0f;
-    enemyConfigs[0].speed = 1.0f;
-    enemyConfigs[0].health = 1;
-    enemyConfigs[0].color = RED;
-    
-    // Wave 2 enemies
-    enemyConfigs[1].size = 45.0f;
-    enemyConfigs[1].speed = 2.0f;
-    enemyConfigs[1].health = 2;
-    enemyConfigs[1].color = MAROON;
-    
-    // Wave 3 enemies
-    enemyConfigs[2].size = 40.0f;
-    enemyConfigs[2].speed = 3.0f;
-    enemyConfigs[2].health = 3;
-    enemyConfigs[2].color = DARKPURPLE;
-    
-    // Scenario config
-    scenario.totalEnemies = 12;
-    scenario.currentWave = 0;
-    scenario.maxWaves = 3;
-    scenario.enemiesPerWave = 4;
-    scenario.baseEnemyHealth = 1;
-    scenario.enemyHealthMultiplier = 1.5f;
-    scenario.enemyColor = RED;
+bool InputHandler::SaveRecording(const std::string& path) const {
+    return recording && recordLog.Save(path);
 }
 
-EntityConfig ConfigManager::GetPlayerConfig() const {
-    return playerConfig;
+void InputHandler::StartPlayback(const InputLog& replay) {
+    playbackLog = replay;
+    playbackTick = 0;
+    playingBack = true;
 }
 
-EntityConfig ConfigManager::GetEnemyConfig(int wave) const {
-    if (wave < 0 || wave >= static_cast<int>(enemyConfigs.size())) {
-        return enemyConfigs[0]; // Return default if out of range
-    }
-    return enemyConfigs[wave];
-}
-
-Scenario ConfigManager::GetScenario() const {
-    return scenario;
-}
-
-// Asset Manager Implementation
-AssetManager::AssetManager() {
-    // Initialize asset manager
-}
-
-void AssetManager::LoadTextures() {
-    // Placeholder for loading textures
-}
-
-void AssetManager::LoadSounds() {
-    // Placeholder for loading sounds
-}
-
-// Player class implementation
-Player::Player(const EntityConfig& config, float startX, float startY)
-    : player{ startX, startY, config.size, config.size }, 
-      speed(config.speed),
-      attacking(false),
-      health(config.health),
-      attackRadius(config.size * 1.5f),
-      invulnerabilityTimer(0.0f),
-      isInvulnerable(false),
-      rotation(0.0f),
-      position{ startX + config.size/2, startY + config.size/2 },
-      velocity{ 0, 0 },
-      rotationSpeed(1.0f),
-      acceleration(0.2f),
-      drag(0.98f) {}
-
-void Player::Update(const InputHandler& input) {
-    // Handle rotation based on direction
-    bool isMoving = false;
-    
-    // Calculate target rotation based on input
-    float targetRotation = rotation;
-    
-    if (input.IsMovingRight() && input.IsMovingUp()) {
-        targetRotation = 315.0f; // Up-right
-        isMoving = true;
-    } else if (input.IsMovingRight() && input.IsMovingDown()) {
-        targetRotation = 45.0f; // Down-right
-        isMoving = true;
-    } else if (input.IsMovingLeft() && input.IsMovingUp()) {
-        targetRotation = 225.0f; // Up-left
-        isMoving = true;
-    } else if (input.IsMovingLeft() && input.IsMovingDown()) {
-        targetRotation = 135.0f; // Down-left
-        isMoving = true;
-    } else if (input.IsMovingRight()) {
-        targetRotation = 0.0f; // Right
-        isMoving = true;
-    } else if (input.IsMovingLeft()) {
-        targetRotation = 180.0f; // Left
-        isMoving = true;
-    } else if (input.IsMovingUp()) {
-        targetRotation = 270.0f; // Up
-        isMoving = true;
-    } else if (input.IsMovingDown()) {
-        targetRotation = 90.0f; // Down
-        isMoving = true;
-    }
-    
-    // Smoothly rotate towards target direction
-    if (isMoving) {
-        // Find the shortest path to rotate
-        float diff = targetRotation - rotation;
-        if (diff > 180.0f) diff -= 360.0f;
-        if (diff < -180.0f) diff += 360.0f;
-        
-        // Apply rotation with the rotation speed
-        rotation += diff * 0.1f * rotationSpeed;
-        
-        // Keep rotation in 0-360 range
-        if (rotation < 0) rotation += 360.0f;
-        if (rotation >= 360.0f) rotation -= 360.0f;
-        
-        // Apply acceleration in the direction of rotation
-        float radians = rotation * DEG2RAD;
-        velocity.x += cos(radians) * acceleration;
-        velocity.y += sin(radians) * acceleration;
-    }
-    
-    // Apply drag to slow down
-    velocity.x *= drag;
-    velocity.y *= drag;
-    
-    // Update position
-    position.x += velocity.x;
-    position.y += velocity.y;
-    
-    // Update rectangle position for collision detection
-    player.x = position.x - player.width/2;
-    player.y = position.y - player.height/2;
-    
-    // Keep player within screen bounds
-    if (position.x < player.width/2) {
-        position.x = player.width/2;
-        velocity.x = 0;
-    }
-    if (position.x > GetScreenWidth() - player.width/2) {
-        position.x = GetScreenWidth() - player.width/2;
-        velocity.x = 0;
-    }
-    if (position.y < player.height/2) {
-        position.y = player.height/2;
-        velocity.y = 0;
-    }
-    if (position.y > GetScreenHeight() - player.height/2) {
-        position.y = GetScreenHeight() - player.height/2;
-        velocity.y = 0;
-    }
-    
-    // Set attacking state
-    attacking = input.IsAttacking();
-    
-    // Update invulnerability timer
-    if (isInvulnerable) {
-        invulnerabilityTimer -= GetFrameTime();
-        if (invulnerabilityTimer <= 0) {
-            isInvulnerable = false;
-        }
-    }
+bool InputHandler::IsPlayingBack() const {
+    return playingBack;
 }
 
-void Player::Draw() const {
+// Player rendering (simulation lives in simulation.cpp)
+void Player::Draw(float alpha, const Sprite* sprite) const {
+    // Blend between the last two simulation steps
+    Vector2 drawPosition = {
+        previousPosition.x + (position.x - previousPosition.x) * alpha,
+        previousPosition.y + (position.y - previousPosition.y) * alpha
+    };
+    float turn = rotation - previousRotation;
+    if (turn > 180.0f) turn -= 360.0f;
+    if (turn < -180.0f) turn += 360.0f;
+    float drawRotation = previousRotation + turn * alpha;
+    
     // Define the triangular ship vertices
     Vector2 v1, v2, v3;
     float shipSize = player.width * 0.8f;
-    float radians = rotation * DEG2RAD;
+    float radians = drawRotation * DEG2RAD;
     
     // Calculate vertices for a triangle pointing in the direction of rotation
-    v1.x = position.x + cos(radians) * shipSize;
-    v1.y = position.y + sin(radians) * shipSize;
+    v1.x = drawPosition.x + cos(radians) * shipSize;
+    v1.y = drawPosition.y + sin(radians) * shipSize;
     
-    v2.x = position.x + cos(radians - 2.5f) * (shipSize * 0.6f);
-    v2.y = position.y + sin(radians - 2.5f) * (shipSize * 0.6f);
+    v2.x = drawPosition.x + cos(radians - 2.5f) * (shipSize * 0.6f);
+    v2.y = drawPosition.y + sin(radians - 2.5f) * (shipSize * 0.6f);
 
-    v3.x = position.x + cos(radians + 2.5f) * (shipSize * 0.6f);
-    v3.y = position.y + sin(radians + 2.5f) * (shipSize * 0.6f);
+    v3.x = drawPosition.x + cos(radians + 2.5f) * (shipSize * 0.6f);
+    v3.y = drawPosition.y + sin(radians + 2.5f) * (shipSize * 0.6f);
     
     // Draw the triangle ship
     Color shipColor = isInvulnerable ? 
         ((static_cast<int>(invulnerabilityTimer * 10) % 2 == 0) ? BLUE : SKYBLUE) : 
         BLUE;
     
-    DrawTriangle(v1, v2, v3, shipColor);
+    if (sprite) {
+        Rectangle destination = { drawPosition.x, drawPosition.y, shipSize * 2.0f, shipSize * 2.0f };
+        DrawTexturePro(sprite->texture, sprite->source, destination, { shipSize, shipSize }, drawRotation, shipColor);
+    } else {
+        DrawTriangle(v1, v2, v3, shipColor);
+    }
     
     // Draw health indicators
     for (int i = 0; i < health; i++) {
@@ -249,109 +157,111 @@ void Player::Draw() const {
     // Draw attack radius if attacking
     if (attacking) {
         for (int i = 0; i < 3; i++) {
-            DrawCircleLines(position.x, position.y, attackRadius + i, RED);
+            DrawCircleLines(drawPosition.x, drawPosition.y, attackRadius + i, RED);
         }
     }
 }
 
-Rectangle Player::GetRectangle() const {
-    return player;
-}
-
-bool Player::IsAttacking() const {
-    return attacking;
-}
-
-void Player::TakeDamage() {
-    if (!isInvulnerable) {
-        health--;
-        isInvulnerable = true;
-        invulnerabilityTimer = 2.0f; // 2 seconds of invulnerability
+// Enemy rendering (simulation lives in simulation.cpp)
+void EnemyDrawState::Draw(float alpha, const Sprite* sprite) const {
+    const size_t count = x.size();
+    for (size_t i = 0; i < count; ++i) {
+        // Blend between the last two simulation steps
+        float drawX = previousX[i] + (x[i] - previousX[i]) * alpha;
+        float drawY = previousY[i] + (y[i] - previousY[i]) * alpha;
+        
+        // Sprites and health bars share the atlas, so they batch together
+        if (sprite) {
+            DrawTexturePro(sprite->texture, sprite->source, { drawX, drawY, size[i], size[i] },
+                           { 0.0f, 0.0f }, 0.0f, color[i]);
+        } else {
+            DrawCircle(
+                drawX + size[i]/2, 
+                drawY + size[i]/2, 
+                size[i]/2, 
+                color[i]
+            );
+        }
+        
+        // Draw health bar above enemy
+        Rectangle healthBar = { drawX, drawY - 10, size[i], 5 };
+        DrawRectangleRec(healthBar, GRAY);
+        Rectangle currentHealth = { 
+            drawX, 
+            drawY - 10, 
+            (size[i] * health[i]) / maxHealth[i], // Scale based on initial health
+            5 
+        };
+        DrawRectangleRec(currentHealth, GREEN);
     }
 }
 
-int Player::GetHealth() const {
-    return health;
-}
-
-bool Player::IsAlive() const {
-    return health > 0;
-}
-
-// Enemy class implementation
-Enemy::Enemy(const EntityConfig& config, float x, float y, float speedX, float speedY)
-    : enemy{ x, y, config.size, config.size }, 
-      color(config.color),
-      speedX(speedX + config.speed), // Add base speed to random speed
-      speedY(speedY + config.speed), 
-      health(config.health),
-      points(health * 100) {}
-
-void Enemy::Update(float deltaTime) {
-    // Update position
-    enemy.x += speedX * deltaTime * 60.0f; // Scale by deltaTime for consistent movement
-    enemy.y += speedY * deltaTime * 60.0f;
-    
-    // Bounce off screen edges
-    if (enemy.x <= 0 || enemy.x + enemy.width >= GetScreenWidth()) {
-        speedX = -speedX;
-        // Correct position to avoid getting stuck at screen edge
-        if (enemy.x <= 0) enemy.x = 0;
-        if (enemy.x + enemy.width >= GetScreenWidth()) enemy.x = GetScreenWidth() - enemy.width;
-    }
-    
-    if (enemy.y <= 0 || enemy.y + enemy.height >= GetScreenHeight()) {
-        speedY = -speedY;
-        // Correct position to avoid getting stuck at screen edge
-        if (enemy.y <= 0) enemy.y = 0;
-        if (enemy.y + enemy.height >= GetScreenHeight()) enemy.y = GetScreenHeight() - enemy.height;
+// Projectile rendering (simulation lives in projectiles.cpp)
+void ProjectileDrawState::Draw(float alpha) const {
+    for (size_t i = 0; i < x.size(); ++i) {
+        // Blend between the last two simulation steps
+        const float drawX = previousX[i] + (x[i] - previousX[i]) * alpha;
+        const float drawY = previousY[i] + (y[i] - previousY[i]) * alpha;
+        DrawCircleV({ drawX, drawY }, ProjectileStore::RADIUS, DARKGRAY);
     }
 }
 
-void Enemy::Draw() const {
-
-    DrawCircle(
-        enemy.x + enemy.width/2, 
-        enemy.y + enemy.height/2, 
-        enemy.width/2, 
-        color
-    );
-    
-    // Draw health bar above enemy
-    Rectangle healthBar = { enemy.x, enemy.y - 10, enemy.width, 5 };
-    DrawRectangleRec(healthBar, GRAY);
-    Rectangle currentHealth = { 
-        enemy.x, 
-        enemy.y - 10, 
-        (enemy.width * health) / (points / 100), // Scale based on initial health (which is points/100)
-        5 
-    };
-    DrawRectangleRec(currentHealth, GREEN);
-}
-
-void Enemy::OnHit(int damage) {
-    health -= damage;
-}
-
-Rectangle Enemy::GetRectangle() const {
-    return enemy;
-}
-
-int Enemy::GetHealth() const {
-    return health;
-}
-
-int Enemy::GetPoints() const {
-    return points;
+// Particle rendering (simulation lives in particles.cpp). Each particle is a
+// quad on the shapes texture, all of them in one rlgl batch instead of a
+// DrawCircle call each; the quads shrink and go transparent as they fade.
+void ParticleSystem::Draw() const {
+    const Texture2D shapes = GetShapesTexture();
+    const Rectangle source = GetShapesTextureRectangle();
+    const float left = source.x / shapes.width;
+    const float top = source.y / shapes.height;
+    const float right = (source.x + source.width) / shapes.width;
+    const float bottom = (source.y + source.height) / shapes.height;
+
+    const size_t chunk = 1024; // Quads per rlBegin, well inside one render batch
+    rlSetTexture(shapes.id);
+    for (size_t order = 0; order < count; ++order) {
+        if (order % chunk == 0) {
+            if (order > 0) rlEnd();
+            rlCheckRenderBatchLimit(static_cast<int>(chunk * 4));
+            rlBegin(RL_QUADS);
+            rlNormal3f(0.0f, 0.0f, 1.0f);
+        }
+        const size_t slot = (head + order) & mask;
+        const float strength = fade[slot];
+        if (strength <= 0.0f) continue;
+
+        const float half = size[slot] * (0.5f + 0.5f * strength) * 0.5f;
+        const Color tint = color[slot];
+        rlColor4ub(tint.r, tint.g, tint.b, static_cast<unsigned char>(tint.a * strength));
+        rlTexCoord2f(left, top);
+        rlVertex2f(x[slot] - half, y[slot] - half);
+        rlTexCoord2f(left, bottom);
+        rlVertex2f(x[slot] - half, y[slot] + half);
+        rlTexCoord2f(right, bottom);
+        rlVertex2f(x[slot] + half, y[slot] + half);
+        rlTexCoord2f(right, top);
+        rlVertex2f(x[slot] + half, y[slot] - half);
+    }
+    if (count > 0) rlEnd();
+    rlSetTexture(0);
 }
 
 // Game class implementation
-Game::Game(int screenWidth, int screenHeight)
+Game::Game(int screenWidth, int screenHeight, int tickRate, uint64_t seed)
     : screenWidth(screenWidth), 
       screenHeight(screenHeight),
-      gameState(GameState::MENU),
-      score(0),
-      gameTimer(0.0f) {
+      tickRate(tickRate),
+      maxStepsPerFrame(5),
+      threaded(true),
+      showProfiler(false),
+      rewindRequested(false),
+      stepMs(0.0f),
+      latencyMs(0.0f),
+      uiLayer(),
+      uiLayerValid(false),
+      uiSnapshot(),
+      frameArena("frame"),
+      seed(seed ? seed : std::random_device()()) {
     Initialize();
 }
 
@@ -362,75 +272,327 @@ Game::~Game() {
 void Game::Initialize() {
     // Initialize handlers and managers
     inputHandler = std::make_unique<InputHandler>();
-    configManager = std::make_unique<ConfigManager>();
-    assetManager = std::make_unique<AssetManager>();
-    
-    // Get scenario configuration
-    scenario = configManager->GetScenario();
     
-    // Initialize player at center of screen
-    const EntityConfig& playerConfig = configManager->GetPlayerConfig();
-    player = std::make_unique<Player>(
-        playerConfig,
-        screenWidth / 2.0f - playerConfig.size / 2,
-        screenHeight / 2.0f - playerConfig.size / 2
+    // Decoding starts right away on the loader thread; uploads wait for the window
+    assetManager = std::make_unique<AssetManager>();
+    assetManager->LoadTextures();
+    assetManager->LoadSounds();
+    
+    // Every hardware thread helps with large enemy updates, this one included
+    jobSystem = std::make_unique<JobSystem>();
+    particles = std::make_unique<ParticleSystem>(8192);
+    
+    // The simulation owns the world and resets itself between games
+    simulation = std::make_unique<Simulation>(
+        static_cast<float>(screenWidth),
+        static_cast<float>(screenHeight),
+        4096,
+        seed
     );
-    score = 0; // Reset score
+    simulation->SetJobSystem(jobSystem.get());
+    simulation->SetParticleSystem(particles.get());
+    rollback = std::make_unique<RollbackBuffer>(*simulation, tickRate);
+    serialState = std::make_unique<RenderState>();
+}
+
+void Game::UseSimulationThread(bool enable) {
+    threaded = enable;
+}
+
+void Game::RecordTo(const std::string& path) {
+    recordPath = path;
+    inputHandler->StartRecording(InputLog(
+        simulation->GetSeed(), tickRate, simulation->GetWorldWidth(), simulation->GetWorldHeight()));
+}
+
+bool Game::ReplayFrom(const std::string& path) {
+    InputLog replay;
+    if (!replay.Load(path)) return false;
     
-    // Clear enemies vector to start fresh
-    enemies.clear();
+    // Replays only match when every step runs as it did while recording
+    seed = replay.GetSeed();
+    tickRate = replay.GetTickRate();
+    simulation = std::make_unique<Simulation>(replay.GetWorldWidth(), replay.GetWorldHeight(), 4096, seed);
+    simulation->SetJobSystem(jobSystem.get());
+    simulation->SetParticleSystem(particles.get());
+    rollback = std::make_unique<RollbackBuffer>(*simulation, tickRate);
+    inputHandler->StartPlayback(replay);
+    return true;
+}
+
+bool Game::LoadConfig(const std::string& path) {
+    auto config = std::make_unique<ConfigManager>();
+    std::string error;
+    if (!config->LoadFromFile(path, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+    simulation->SetConfig(std::move(config));
+    configWatcher = std::make_unique<ConfigWatcher>(path);
+    return true;
 }
 
 void Game::Run() {
     InitWindow(screenWidth, screenHeight, "Asteroids!");
-    SetTargetFPS(60);
+    InitAudioDevice();
+    
+    // Render at the display's rate; the simulation keeps its own fixed rate
+    int refreshRate = GetMonitorRefreshRate(GetCurrentMonitor());
+    SetTargetFPS(refreshRate > 0 ? refreshRate : 60);
+    
+    // Needs the GL context, so created here rather than in Initialize
+    uiLayer = LoadRenderTexture(screenWidth, screenHeight);
+    uiLayerValid = false;
+    
+    if (threaded) {
+        RunThreaded();
+    } else {
+        RunSerial();
+    }
+    
+    if (!recordPath.empty()) {
+        inputHandler->SaveRecording(recordPath);
+    }
+    
+    UnloadRenderTexture(uiLayer);
+    assetManager->Unload();
+    CloseAudioDevice();
+    CloseWindow();
+    
+#ifdef ASTEROIDS_ALLOC_TRACKING
+    AllocTracker::Report(stdout);
+#endif
+}
+
+void Game::RunSerial() {
+    const float tickLength = 1.0f / tickRate;
+    float accumulator = 0.0f;
     
     // Game loop
     while (!WindowShouldClose()) {
-        float deltaTime = GetFrameTime();
+        Profiler::BeginFrame();
+        accumulator += GetFrameTime();
         
         // Update input handler
-        inputHandler->Update();
+        const int64_t sampleTime = Profiler::Now();
+        {
+            PROFILE_SCOPE("input");
+            inputHandler->Update();
+            HandleDebugKeys();
+        }
+        
+        // Run as many fixed steps as the elapsed time covers
+        int steps = 0;
+        int64_t stepNanoseconds = 0;
+        {
+            PROFILE_SCOPE("simulation");
+            while (accumulator >= tickLength && steps < maxStepsPerFrame) {
+                BetweenSteps();
+                const int64_t start = Profiler::Now();
+                rollback->Step(*simulation, tickLength, inputHandler->NextStep(inputHandler->GetState()));
+                stepNanoseconds = Profiler::Now() - start;
+                inputHandler->ConsumePresses();
+                accumulator -= tickLength;
+                steps++;
+            }
+        }
+        
+        // After a long stall, drop the time we can't catch up on instead of
+        // spiralling further behind
+        if (steps == maxStepsPerFrame && accumulator >= tickLength) {
+            accumulator = 0.0f;
+        }
+        
+        // Particles follow the frame time rather than the steps; they freeze
+        // while paused and go when the game ends
+        if (simulation->GetState() == GameState::PLAYING) {
+            particles->Update(GetFrameTime());
+        } else if (simulation->GetState() != GameState::PAUSED) {
+            particles->Clear();
+        }
+        
+        // The same copy the simulation thread would publish, so both loops
+        // draw alike
+        {
+            PROFILE_SCOPE("capture");
+            serialState->Capture(*simulation, particles.get());
+            if (steps > 0) {
+                serialState->inputTime = sampleTime;
+                serialState->stepNanoseconds = stepNanoseconds;
+            }
+        }
+        
+        // Finished asset loads go to the GPU between frames
+        assetManager->Update();
         
-        // Update game based on current state
-        Update(deltaTime);
+        // Draw everything, blended between the last two steps
+        Draw(*serialState, accumulator / tickLength);
+        frameArena.Reset();
+        Profiler::EndFrame();
+        AllocTracker::EndFrame();
+    }
+}
+
+void Game::RunThreaded() {
+    // The simulation, its rollback buffer, the particles and the input
+    // handler's replay and recording belong to the simulation thread until
+    // it stops; this thread only hands it input and draws what it publishes
+    SimulationThread simulationThread(*simulation, rollback.get(), particles.get(), tickRate, maxStepsPerFrame);
+    simulationThread.SetInputFilter([this](const InputState& live) { return inputHandler->NextStep(live); });
+    simulationThread.SetBetweenSteps([this]() { BetweenSteps(); });
+    simulationThread.Start();
+    
+    const float tickNanoseconds = 1e9f / tickRate;
+    
+    // Game loop
+    while (!WindowShouldClose()) {
+        Profiler::BeginFrame();
         
-        // Draw everything
-        Draw();
+        {
+            PROFILE_SCOPE("input");
+            inputHandler->Update();
+            HandleDebugKeys();
+            simulationThread.SubmitInput(inputHandler->GetState(), Profiler::Now());
+            inputHandler->ConsumePresses();
+        }
+        
+        // Finished asset loads go to the GPU between frames
+        assetManager->Update();
+        
+        // The newest state, blended from its previous step by how long ago
+        // it was due
+        if (const RenderState* state = simulationThread.FetchState()) {
+            float alpha = (Profiler::Now() - state->stepTime) / tickNanoseconds;
+            alpha = alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha);
+            Draw(*state, alpha);
+        } else {
+            BeginDrawing();
+            ClearBackground(RAYWHITE);
+            EndDrawing();
+        }
+        frameArena.Reset();
+        Profiler::EndFrame();
+        AllocTracker::EndFrame();
     }
     
-    CloseWindow();
+    simulationThread.Stop();
 }
 
-void Game::Update(float deltaTime) {
-    switch (gameState) {
-        case GameState::MENU:
-            HandleMenuState();
-            break;
+void Game::BetweenSteps() {
+    // Configs reloaded in the background are swapped in between steps
+    if (configWatcher) {
+        if (std::unique_ptr<ConfigManager> config = configWatcher->TakeUpdate()) {
+            simulation->SetConfig(std::move(config));
+        }
+    }
+    
+    // Rewind to the oldest kept step, about a second back. Recordings would
+    // no longer match their game, so not while recording or replaying.
+    if (rewindRequested.exchange(false) && recordPath.empty() && !inputHandler->IsPlayingBack() &&
+        rollback->GetSize() > 0) {
+        rollback->Rewind(*simulation, rollback->GetOldestTick());
+    }
+}
+
+void Game::HandleDebugKeys() {
+    // F3 toggles recording and the overlay, F4 saves the buffered frames
+    if (IsKeyPressed(KEY_F3)) {
+        showProfiler = !showProfiler;
+        Profiler::SetEnabled(showProfiler);
+    }
+    if (IsKeyPressed(KEY_F4) && Profiler::GetFrameCount() > 0) {
+        Profiler::ExportChromeTrace("asteroids_trace.json");
+    }
+    
+    // F5 rewinds about a second, before the next step
+    if (IsKeyPressed(KEY_F5)) {
+        rewindRequested = true;
+    }
+}
+
+void Game::Draw(const RenderState& state, float alpha) {
+    PROFILE_SCOPE("draw");
+    
+    // Text only changes with the state, score, wave or enemy count, so it is
+    // drawn into a cached layer and only redrawn when one of those changed
+    UpdateUiLayer(state);
+    
+    BeginDrawing();
+    ClearBackground(RAYWHITE);
+    
+    switch (state.state) {
+        case GameState::PLAYING: {
+            // Draw game entities
+            PROFILE_SCOPE("draw_entities");
+            state.player->Draw(alpha, assetManager->GetSprite("ship"));
             
-        case GameState::PLAYING:
-            HandlePlayingState(deltaTime);
+            state.enemies.Draw(alpha, assetManager->GetSprite("asteroid"));
+            state.projectiles.Draw(alpha);
+            state.particles.Draw();
             break;
+        }
             
         case GameState::PAUSED:
-            HandlePausedState();
-            break;
+            // Draw game entities (as background)
+            state.player->Draw(alpha, assetManager->GetSprite("ship"));
             
-        case GameState::GAME_OVER:
-            HandleGameOverState();
+            state.enemies.Draw(alpha, assetManager->GetSprite("asteroid"));
+            state.projectiles.Draw(alpha);
+            state.particles.Draw();
+            
+            // Dim them under the pause text
+            DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, 0.5f));
             break;
             
-        case GameState::VICTORY:
-            HandleVictoryState();
+        default:
             break;
     }
+    
+    // Render textures are stored bottom-up, hence the negative height
+    DrawTextureRec(uiLayer.texture, { 0.0f, 0.0f, static_cast<float>(screenWidth), -static_cast<float>(screenHeight) },
+                   { 0.0f, 0.0f }, WHITE);
+    
+    if (showProfiler) {
+        DrawProfilerOverlay();
+    }
+    
+    {
+        PROFILE_SCOPE("present");
+        EndDrawing();
+    }
+    
+    // How old the newest input on screen is, for the overlay
+    stepMs = state.stepNanoseconds / 1e6f;
+    if (state.inputTime > 0) {
+        const float latency = (Profiler::Now() - state.inputTime) / 1e6f;
+        latencyMs = latencyMs > 0.0f ? latencyMs * 0.95f + latency * 0.05f : latency;
+    }
 }
 
-void Game::Draw() {
-    BeginDrawing();
-    ClearBackground(RAYWHITE);
+void Game::UpdateUiLayer(const RenderState& state) {
+    UiSnapshot snapshot;
+    snapshot.state = state.state;
+    snapshot.score = state.score;
+    snapshot.wave = state.wave;
+    snapshot.maxWaves = state.maxWaves;
+    snapshot.enemyCount = static_cast<int>(state.enemies.Count());
     
-    switch (gameState) {
+    if (uiLayerValid && snapshot.state == uiSnapshot.state && snapshot.score == uiSnapshot.score &&
+        snapshot.wave == uiSnapshot.wave && snapshot.maxWaves == uiSnapshot.maxWaves &&
+        snapshot.enemyCount == uiSnapshot.enemyCount) {
+        return;
+    }
+    uiSnapshot = snapshot;
+    uiLayerValid = true;
+    
+    PROFILE_SCOPE("redraw_ui_layer");
+    BeginTextureMode(uiLayer);
+    ClearBackground(BLANK);
+    
+    const int score = snapshot.score;
+    const char* finalScore = nullptr;
+    
+    switch (snapshot.state) {
         case GameState::MENU:
             // Menu UI
             DrawText("ASTEROIDS!", screenWidth / 2 - MeasureText("ASTEROIDS!", 40) / 2, screenHeight / 4, 40, BLACK);
@@ -441,229 +603,169 @@ void Game::Draw() {
             break;
             
         case GameState::PLAYING:
-            // Draw game entities
-            player->Draw();
-            
-            for (const auto& enemy : enemies) {
-                enemy->Draw();
-            }
-            
             // Draw game UI
             DrawUI();
             break;
             
         case GameState::PAUSED:
-            // Draw game entities (as background)
-            player->Draw();
-            
-            for (const auto& enemy : enemies) {
-                enemy->Draw();
-            }
-            
             // Draw pause overlay
-            DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, 0.5f));
             DrawText("PAUSED", screenWidth / 2 - MeasureText("PAUSED", 40) / 2, screenHeight / 2 - 40, 40, WHITE);
             DrawText("Press P to resume", screenWidth / 2 - MeasureText("Press P to resume", 20) / 2, screenHeight / 2 + 20, 20, WHITE);
             break;
             
         case GameState::GAME_OVER:
             DrawText("GAME OVER", screenWidth / 2 - MeasureText("GAME OVER", 60) / 2, screenHeight / 3, 60, RED);
-            DrawText(TextFormat("Final Score: %d", score), screenWidth / 2 - MeasureText(TextFormat("Final Score: %d", score), 30) / 2, screenHeight / 2, 30, BLACK);
+            finalScore = frameArena.Format("Final Score: %d", score);
+            DrawText(finalScore, screenWidth / 2 - MeasureText(finalScore, 30) / 2, screenHeight / 2, 30, BLACK);
             DrawText("Press ENTER to restart", screenWidth / 2 - MeasureText("Press ENTER to restart", 20) / 2, screenHeight * 2 / 3, 20, DARKGRAY);
             break;
             
         case GameState::VICTORY:
             DrawText("VICTORY!", screenWidth / 2 - MeasureText("VICTORY!", 60) / 2, screenHeight / 3, 60, GREEN);
-            DrawText(TextFormat("Final Score: %d", score), screenWidth / 2 - MeasureText(TextFormat("Final Score: %d", score), 30) / 2, screenHeight / 2, 30, BLACK);
+            finalScore = frameArena.Format("Final Score: %d", score);
+            DrawText(finalScore, screenWidth / 2 - MeasureText(finalScore, 30) / 2, screenHeight / 2, 30, BLACK);
             DrawText("Press ENTER to restart", screenWidth / 2 - MeasureText("Press ENTER to restart", 20) / 2, screenHeight * 2 / 3, 20, DARKGRAY);
             break;
     }
     
-    EndDrawing();
-}
-
-void Game::SpawnEnemies(int count) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> disPosX(0, screenWidth - 50);
-    std::uniform_real_distribution<> disPosY(0, screenHeight - 50);
-    std::uniform_real_distribution<> disSpeed(0, 2);
-    
-    const EntityConfig& enemyConfig = configManager->GetEnemyConfig(scenario.currentWave);
-    
-    for (int i = 0; i < count; ++i) {
-        float x = disPosX(gen);
-        float y = disPosY(gen);
-        
-        // Ensure enemy doesn't spawn too close to player
-        Rectangle playerRect = player->GetRectangle();
-        float minDistance = 150.0f;
-        
-        // Keep generating positions until we find one far enough away
-        while (std::sqrt(std::pow(x - playerRect.x, 2) + std::pow(y - playerRect.y, 2)) < minDistance) {
-            x = disPosX(gen);
-            y = disPosY(gen);
-        }
-        
-        float speedX = disSpeed(gen);
-        float speedY = disSpeed(gen);
-        
-        // 50% chance to reverse direction
-        if (std::uniform_int_distribution<>(0, 1)(gen)) speedX = -speedX;
-        if (std::uniform_int_distribution<>(0, 1)(gen)) speedY = -speedY;
-        
-        enemies.emplace_back(std::make_unique<Enemy>(enemyConfig, x, y, speedX, speedY));
-    }
-}
-
-void Game::CheckAttackCollisions() {
-    if (!player->IsAttacking()) {
-        return;
-    }
-    
-    Rectangle attackArea = GetAttackArea(player->GetRectangle());
-    
-    for (auto& enemy : enemies) {
-        if (CheckCollisionRecs(attackArea, enemy->GetRectangle())) {
-            HandleEnemyHit(enemy);
-        }
-    }
-    
-    RemoveDeadEnemies();
-    
-    // Check if all enemies are defeated to start new wave
-    if (enemies.empty()) {
-        if (scenario.currentWave < scenario.maxWaves - 1) {
-            StartNewWave();
-        } else {
-            Victory();
-        }
-    }
-}
-
-void Game::CheckPlayerEnemyCollisions() {
-    if (!player->IsAlive()) return;
-    
-    Rectangle playerRect = player->GetRectangle();
-    
-    for (const auto& enemy : enemies) {
-        if (CheckCollisionRecs(playerRect, enemy->GetRectangle())) {
-            player->TakeDamage();
-            
-            // Check if player died
-            if (!player->IsAlive()) {
-                GameOver();
-                break;
-            }
-        }
-    }
-}
-
-Rectangle Game::GetAttackArea(const Rectangle& playerRect) {
-    float attackRadius = playerRect.width * 1.5f;
-    return {
-        playerRect.x + playerRect.width / 2 - attackRadius,
-        playerRect.y + playerRect.height / 2 - attackRadius,
-        attackRadius * 2,
-        attackRadius * 2
-    };
-}
-
-void Game::HandleEnemyHit(std::unique_ptr<Enemy>& enemy) {
-    enemy->OnHit();
-    
-    if (enemy->GetHealth() <= 0) {
-        score += enemy->GetPoints() * (scenario.currentWave + 1);
-    }
-}
-
-void Game::RemoveDeadEnemies() {
-    enemies.erase(
-        std::remove_if(enemies.begin(), enemies.end(),
-            [](const std::unique_ptr<Enemy>& enemy) { return enemy->GetHealth() <= 0; }),
-        enemies.end()
-    );
-}
-
-void Game::StartNewWave() {
-    scenario.currentWave++;
-    SpawnEnemies(scenario.enemiesPerWave);
-}
-
-void Game::GameOver() {
-    gameState = GameState::GAME_OVER;
-}
-
-void Game::Victory() {
-    gameState = GameState::VICTORY;
+    EndTextureMode();
 }
 
 void Game::DrawUI() {
+    PROFILE_SCOPE("draw_ui");
+    
     // Draw score
-    DrawText(TextFormat("Score: %d", score), 10, 40, 20, BLACK);
+    DrawText(frameArena.Format("Score: %d", uiSnapshot.score), 10, 40, 20, BLACK);
     
     // Draw wave information
-    DrawText(TextFormat("Wave: %d/%d", scenario.currentWave + 1, scenario.maxWaves), 10, 70, 20, BLACK);
+    DrawText(frameArena.Format("Wave: %d/%d", uiSnapshot.wave + 1, uiSnapshot.maxWaves), 10, 70, 20, BLACK);
     
     // Draw enemies remaining
-    DrawText(TextFormat("Enemies: %d", static_cast<int>(enemies.size())), 10, 100, 20, BLACK);
-}
-
-void Game::HandleMenuState() {
-    if (IsKeyPressed(KEY_ENTER)) {
-        // Reset game state
-        Initialize();
+    DrawText(frameArena.Format("Enemies: %d", uiSnapshot.enemyCount), 10, 100, 20, BLACK);
+}
+
+void Game::DrawProfilerOverlay() {
+    PROFILE_SCOPE("draw_profiler");
+    
+    const int frameCount = Profiler::GetFrameCount();
+    const int graphWidth = Profiler::MAX_FRAMES;
+    const int graphHeight = 100;
+    const float pixelsPerMs = graphHeight / 33.3f; // Graph tops out at two 60 Hz frames
+    const int left = screenWidth - graphWidth - 10;
+    const int top = 10;
+    
+    // Colors for the top-level phases, assigned in order of first appearance
+    static const Color palette[] = { BLUE, ORANGE, GREEN, PURPLE, MAROON, GOLD, LIME, PINK };
+    const int maxPhases = sizeof(palette) / sizeof(palette[0]);
+    const char* phaseNames[maxPhases] = {};
+    double phaseTotals[maxPhases] = {};
+    int phaseCount = 0;
+    
+    // Other scopes, averaged for the breakdown list
+    const int maxScopes = 24;
+    const char* scopeNames[maxScopes] = {};
+    uint32_t scopeDepths[maxScopes] = {};
+    double scopeTotals[maxScopes] = {};
+    int scopeCount = 0;
+    
+    const int averagedFrames = frameCount < 60 ? frameCount : 60;
+    double frameTotal = 0.0;
+    
+    DrawRectangle(left - 5, top - 5, graphWidth + 10, graphHeight + 10, Fade(BLACK, 0.6f));
+    
+    for (int age = 0; age < frameCount; ++age) {
+        const ProfileFrame& frame = Profiler::GetFrame(age);
+        const int column = left + graphWidth - 1 - age;
+        const int bottom = top + graphHeight;
+        float stacked = 0.0f;
         
-        // Start first wave
-        SpawnEnemies(
-            scenario.enemiesPerWave
-        );
+        for (int i = 0; i < frame.eventCount; ++i) {
+            const ProfileEvent& event = frame.events[i];
+            const double ms = (event.end - event.start) / 1e6;
+            
+            if (event.depth == 0) {
+                int phase = 0;
+                while (phase < phaseCount && phaseNames[phase] != event.name) phase++;
+                if (phase == phaseCount && phaseCount < maxPhases) phaseNames[phaseCount++] = event.name;
+                if (phase >= maxPhases) continue;
+                if (age < averagedFrames) phaseTotals[phase] += ms;
+                
+                // Stack this phase on top of the ones before it
+                float height = static_cast<float>(ms) * pixelsPerMs;
+                int y0 = bottom - static_cast<int>(stacked + height);
+                int y1 = bottom - static_cast<int>(stacked);
+                if (y1 > y0) DrawLine(column, y0 < top ? top : y0, column, y1, palette[phase]);
+                stacked += height;
+            } else if (age < averagedFrames) {
+                int scope = 0;
+                while (scope < scopeCount && scopeNames[scope] != event.name) scope++;
+                if (scope == scopeCount && scopeCount < maxScopes) {
+                    scopeNames[scopeCount] = event.name;
+                    scopeDepths[scopeCount] = event.depth;
+                    scopeCount++;
+                }
+                if (scope < maxScopes) scopeTotals[scope] += ms;
+            }
+        }
         
-        gameState = GameState::PLAYING;
+        // Whatever the phases didn't cover
+        const double frameMs = (frame.end - frame.start) / 1e6;
+        if (age < averagedFrames) frameTotal += frameMs;
+        int frameTop = bottom - static_cast<int>(frameMs * pixelsPerMs);
+        int stackedTop = bottom - static_cast<int>(stacked);
+        if (stackedTop > frameTop) DrawLine(column, frameTop < top ? top : frameTop, column, stackedTop, GRAY);
     }
-}
-
-void Game::HandlePlayingState(float deltaTime) {
-    // Update game time
-    gameTimer += deltaTime;
-    
-    // Update player
-    player->Update(*inputHandler);
     
-    // Update enemies
-    for (auto& enemy : enemies) {
-        enemy->Update(deltaTime);
+    // 60 Hz budget line
+    const int budgetY = top + graphHeight - static_cast<int>(16.6f * pixelsPerMs);
+    DrawLine(left, budgetY, left + graphWidth, budgetY, RED);
+    
+    // Averages over the last second or so
+    if (averagedFrames == 0) return;
+    int textY = top + graphHeight + 10;
+    const int lineHeight = 12;
+    const int listHeight = (3 + phaseCount + scopeCount) * lineHeight;
+    DrawRectangle(left - 5, textY - 5, graphWidth + 10, listHeight + 10, Fade(BLACK, 0.6f));
+    
+    DrawText(frameArena.Format("frame %.2f ms  (F4: save trace)", frameTotal / averagedFrames), left, textY, 10, WHITE);
+    textY += lineHeight;
+    // With the simulation on its own thread its steps aren't in the graph
+    DrawText(frameArena.Format("%s step %.2f ms  input lag %.1f ms", threaded ? "threaded" : "serial", stepMs, latencyMs),
+             left, textY, 10, WHITE);
+    textY += lineHeight * 2;
+    for (int phase = 0; phase < phaseCount; ++phase) {
+        DrawRectangle(left, textY + 1, 8, 8, palette[phase]);
+        DrawText(frameArena.Format("%s %.3f ms", phaseNames[phase], phaseTotals[phase] / averagedFrames), left + 12, textY, 10, WHITE);
+        textY += lineHeight;
     }
-    
-    // Check for pause
-    if (inputHandler->IsPausePressed()) {
-        gameState = GameState::PAUSED;
-        return;
+    for (int scope = 0; scope < scopeCount; ++scope) {
+        DrawText(frameArena.Format("%s %.3f ms", scopeNames[scope], scopeTotals[scope] / averagedFrames),
+                 left + 12 + 8 * static_cast<int>(scopeDepths[scope]), textY, 10, LIGHTGRAY);
+        textY += lineHeight;
     }
     
-    // Check collisions
-    CheckAttackCollisions();
-    CheckPlayerEnemyCollisions();
-}
-
-void Game::HandlePausedState() {
-    if (inputHandler->IsPausePressed()) {
-        gameState = GameState::PLAYING;
+#ifdef ASTEROIDS_ALLOC_TRACKING
+    // Last frame's heap traffic and the scopes it came from; a steady frame
+    // should show none
+    const AllocCounts heap = AllocTracker::GetLastFrame();
+    int allocatingScopes = 0;
+    for (int scope = 0; scope < AllocTracker::GetScopeCount(); ++scope) {
+        if (AllocTracker::GetScope(scope).lastFrame.allocations > 0) allocatingScopes++;
     }
-}
-
-void Game::HandleGameOverState() {
-    if (IsKeyPressed(KEY_ENTER)) {
-        // Reset game and go to menu
-        Initialize();
-        gameState = GameState::MENU;
+    textY += 10;
+    DrawRectangle(left - 5, textY - 5, graphWidth + 10, (1 + allocatingScopes) * lineHeight + 10, Fade(BLACK, 0.6f));
+    DrawText(frameArena.Format("heap %llu allocs (%llu bytes), %llu frees",
+                               static_cast<unsigned long long>(heap.allocations),
+                               static_cast<unsigned long long>(heap.allocatedBytes),
+                               static_cast<unsigned long long>(heap.frees)),
+             left, textY, 10, heap.allocations > 0 ? ORANGE : WHITE);
+    textY += lineHeight;
+    for (int scope = 0; scope < AllocTracker::GetScopeCount(); ++scope) {
+        const AllocScopeStats stats = AllocTracker::GetScope(scope);
+        if (stats.lastFrame.allocations == 0) continue;
+        DrawText(frameArena.Format("%s %llu allocs", stats.name, static_cast<unsigned long long>(stats.lastFrame.allocations)),
+                 left + 12, textY, 10, LIGHTGRAY);
+        textY += lineHeight;
     }
+#endif
 }
-
-void Game::HandleVictoryState() {
-    if (IsKeyPressed(KEY_ENTER)) {
-        // Reset game and go to menu
-        Initialize();
-        gameState = GameState::MENU;
-    }
-}
\ No newline at end of file
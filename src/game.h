@@ -2,44 +2,21 @@
 #define GAME_H
 
 #include "raylib.h"
+#include "simulation.h"
+#include "input_log.h"
+#include "job_system.h"
+#include "rollback.h"
+#include "config_watcher.h"
+#include "asset_manager.h"
+#include "particles.h"
+#include "frame_arena.h"
+#include "render_state.h"
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
-// Forward declarations
-class InputHandler;
-class ConfigManager;
-class AssetManager;
-
-// Game states
-enum class GameState {
-    MENU,
-    PLAYING,
-    PAUSED,
-    GAME_OVER,
-    VICTORY
-};
-
-// Configuration struct for game entities
-struct EntityConfig {
-    float size;
-    float speed;
-    int health;
-    Color color;
-};
-
-// Game scenario definition
-struct Scenario {
-    int totalEnemies;
-    int currentWave;
-    int maxWaves;
-    int enemiesPerWave;
-    int baseEnemyHealth;
-    float enemyHealthMultiplier;
-    Color enemyColor;
-};
-
 // Input handler class to decouple input from game logic
 class InputHandler {
 public:
@@ -50,127 +27,104 @@ public:
     bool IsMovingUp() const;
     bool IsMovingDown() const;
     bool IsAttacking() const;
+    bool IsFiring() const;
     bool IsPausePressed() const;
+    bool IsStartPressed() const;
     void Update();
-
-private:
-    bool attackPressed;
-    bool pausePressed;
-};
-
-// Configuration manager class
-class ConfigManager {
-public:
-    ConfigManager();
+    // Clears the latched presses once a simulation step has seen them
+    void ConsumePresses();
     
-    EntityConfig GetPlayerConfig() const;
-    EntityConfig GetEnemyConfig(int wave) const;
-    Scenario GetScenario() const;
-
-private:
-    EntityConfig playerConfig;
-    std::vector<EntityConfig> enemyConfigs;
-    Scenario scenario;
+    // Snapshot of this frame's input for the simulation
+    InputState GetState() const;
     
-    void LoadConfigs();
-};
-
-// Asset manager class (placeholder for future texture/sound loading)
-class AssetManager {
-public:
-    AssetManager();
-    
-    // Placeholder methods for future implementation
-    void LoadTextures();
-    void LoadSounds();
+    // Input for the next simulation step: live, or the next entry of the
+    // replay while one is playing. Records it when recording. Doesn't read
+    // the keyboard, so it can run on the simulation thread.
+    InputState NextStep(const InputState& live);
     
-    // Method to get textures when implemented
-    // Texture2D GetTexture(const std::string& name) const;
-};
-
-class Player {
-public:
-    Player(const EntityConfig& config, float startX, float startY);
-    void Update(const InputHandler& input);
-    void Draw() const;
-    Rectangle GetRectangle() const;
-    bool IsAttacking() const;
-    void TakeDamage();
-    int GetHealth() const;
-    bool IsAlive() const;
+    void StartRecording(const InputLog& header);
+    bool SaveRecording(const std::string& path) const;
+    void StartPlayback(const InputLog& replay);
+    bool IsPlayingBack() const;
 
 private:
-    Rectangle player;
-    float speed;
-    bool attacking;
-    int health;
-    float attackRadius;
-    float invulnerabilityTimer;
-    bool isInvulnerable;
-    float rotation;      // Rotation angle in degrees
-    Vector2 position;    // Center position of the player
-    Vector2 velocity;    // Current velocity vector
-    float rotationSpeed; // How quickly the ship rotates
-    float acceleration;  // Movement acceleration
-    float drag;          // Deceleration factor
+    bool attackPressed;
+    bool pausePressed;
+    bool startPressed;
+    bool recording;
+    bool playingBack;
+    size_t playbackTick;
+    InputLog recordLog;
+    InputLog playbackLog;
 };
 
-class Enemy {
-public:
-    Enemy(const EntityConfig& config, float x, float y, float speedX, float speedY);
-    void Update(float deltaTime);
-    void Draw() const;
-    void OnHit(int damage = 1);
-    Rectangle GetRectangle() const;
-    int GetHealth() const;
-    int GetPoints() const;
-
-private:
-    Rectangle enemy;
-    Color color;
-    float speedX;
-    float speedY;
-    int health;
-    int points;
+// Values the cached UI text depends on
+struct UiSnapshot {
+    GameState state = GameState::MENU;
+    int score = 0;
+    int wave = 0;
+    int maxWaves = 0;
+    int enemyCount = 0;
 };
 
+// Windowed front end: samples input, steps the simulation and draws it
 class Game {
 public:
-    Game(int screenWidth, int screenHeight);
+    // tickRate is the fixed simulation rate in steps per second. A seed of 0
+    // picks a random one.
+    Game(int screenWidth, int screenHeight, int tickRate = 60, uint64_t seed = 0);
     ~Game();
     void Run();
+    
+    // Call before Run. By default the simulation steps on its own thread and
+    // the window thread only samples input and draws the newest state it
+    // published; off, both happen one after the other on the window thread.
+    void UseSimulationThread(bool enable);
+    
+    // Call before Run. Recording saves every step's input to path on exit;
+    // replaying restarts the simulation with the log's seed and feeds it the
+    // logged input, handing control back to the keyboard when it runs out.
+    void RecordTo(const std::string& path);
+    bool ReplayFrom(const std::string& path);
+    // Loads a compiled config and keeps watching it; edits are swapped in
+    // between steps. Config swaps aren't recorded in input logs.
+    bool LoadConfig(const std::string& path);
 
 private:
     int screenWidth;
     int screenHeight;
-    Scenario scenario;
-    std::unique_ptr<Player> player;
-    std::vector<std::unique_ptr<Enemy>> enemies;
+    int tickRate;
+    int maxStepsPerFrame; // Catch-up cap after slow frames
+    bool threaded;        // Simulation on its own thread
+    bool showProfiler;    // Frame profiler overlay (F3)
+    std::atomic<bool> rewindRequested; // F5, applied between steps
+    float stepMs;         // Cost of the last step drawn
+    float latencyMs;      // Input sample to present, smoothed
+    RenderTexture2D uiLayer; // Cached menu and HUD text, screen sized
+    bool uiLayerValid;
+    UiSnapshot uiSnapshot;   // What uiLayer currently shows
+    FrameArena frameArena;   // UI text and other per-frame data, reset after each frame
+    uint64_t seed;
+    std::string recordPath;
+    std::unique_ptr<JobSystem> jobSystem; // Declared first so it outlives the simulation
+    std::unique_ptr<ParticleSystem> particles; // Likewise; the simulation emits into it
+    std::unique_ptr<Simulation> simulation;
+    std::unique_ptr<RollbackBuffer> rollback; // Last second of steps, for F5
     std::unique_ptr<InputHandler> inputHandler;
-    std::unique_ptr<ConfigManager> configManager;
     std::unique_ptr<AssetManager> assetManager;
-    GameState gameState;
-    int score;
-    float gameTimer;
+    std::unique_ptr<ConfigWatcher> configWatcher;
+    std::unique_ptr<RenderState> serialState; // What the serial loop draws
     
     void Initialize();
-    void Update(float deltaTime);
-    void Draw();
-    void SpawnEnemies(int count);
-    void CheckAttackCollisions();
-    void CheckPlayerEnemyCollisions();
-    Rectangle GetAttackArea(const Rectangle& playerRect);
-    void HandleEnemyHit(std::unique_ptr<Enemy>& enemy);
-    void RemoveDeadEnemies();
-    void StartNewWave();
-    void GameOver();
-    void Victory();
+    void RunSerial();
+    void RunThreaded();
+    // Config swaps and rewinds, on whichever thread steps the simulation
+    void BetweenSteps();
+    void HandleDebugKeys();
+    void Draw(const RenderState& state, float alpha);
+    void UpdateUiLayer(const RenderState& state);
     void DrawUI();
-    void HandleMenuState();
-    void HandlePlayingState(float deltaTime);
-    void HandlePausedState();
-    void HandleGameOverState();
-    void HandleVictoryState();
+    void DrawProfilerOverlay();
 };
 
-#endif // GAME_H
\ No newline at end of file
+#endif // GAME_H
@@ -0,0 +1,700 @@
+#include "simulation.h"
+#include "enemy_kernels.h"
+#include "input_log.h"
+#include "job_system.h"
+#include "rollback.h"
+#include "collision.h"
+#include "scripted_input.h"
+#include "profiler.h"
+#include "alloc_tracker.h"
+#include "sim_thread.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Headless driver: steps the simulation as fast as the CPU allows with scripted
+// input, restarting whenever a game ends. Useful for soak tests, balancing runs
+// and profiling on machines without a display.
+
+struct HeadlessOptions {
+    long long frames = 100000;
+    float deltaTime = 1.0f / 60.0f;
+    float worldWidth = 800.0f;
+    float worldHeight = 600.0f;
+    unsigned int inputSeed = 1;
+    uint64_t seed = 1;
+    size_t threads = 1;
+    const char* recordPath = nullptr;
+    const char* configPath = nullptr;
+    const char* replayPath = nullptr;
+    bool checkKernels = false;
+    bool checkRollback = false;
+    bool checkSweep = false;
+    bool allocGate = false;
+    double frameLoopSeconds = 0.0;
+    double drawMs = 4.0;
+    int enemies = 0;
+    const char* profilePath = nullptr;
+};
+
+static void PrintUsage(const char* program) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "  --frames N      Number of simulation steps to run (default 100000)\n"
+        "  --dt SECONDS    Step length in seconds (default 1/60)\n"
+        "  --world W H     World size (default 800 600)\n"
+        "  --input-seed N  Seed for the scripted input (default 1)\n"
+        "  --seed N        Seed for the simulation (default 1)\n"
+        "  --record PATH   Save the scripted input as a replay\n"
+        "  --replay PATH   Run a recorded session instead of scripted input; its seed,\n"
+        "                  step rate and world size override the options above\n"
+        "  --config PATH   Compiled config to play with (default: built in)\n"
+        "  --threads N     Threads for the enemy update and large queries, 0 = all (default 1)\n"
+        "  --kernel NAME   Enemy integration kernel: scalar, sse2 or avx2 (default: best)\n"
+        "  --check-kernels Verify every supported integration and sweep kernel matches\n"
+        "                  the scalar one bit for bit\n"
+        "  --check-rollback Verify that rolling back and resimulating, with the same or\n"
+        "                  corrected input, matches straight runs\n"
+        "  --check-sweep   Verify the swept collision tests, that fast asteroids hit\n"
+        "                  the same at 60 and 2 steps per second, and that asteroid\n"
+        "                  collisions conserve momentum and energy\n"
+        "  --alloc-gate    Fail if a playing step allocates once warmed up (runs --frames\n"
+        "                  scripted steps)\n"
+        "  --frame-loop SECONDS  Run the serial and the threaded game loop for SECONDS\n"
+        "                  each against a 60 Hz display and compare frame rate, step\n"
+        "                  rate and input-to-present latency\n"
+        "  --draw-ms MS    CPU time a --frame-loop frame spends drawing (default 4)\n"
+        "  --enemies N     Keep at least N asteroids in play during --frame-loop\n"
+        "  --profile PATH  Record the last 240 steps and write them as a Chrome trace\n",
+        program
+    );
+}
+
+static bool ParseOptions(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frames = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--dt") == 0 && i + 1 < argc) {
+            options.deltaTime = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--world") == 0 && i + 2 < argc) {
+            options.worldWidth = static_cast<float>(std::atof(argv[++i]));
+            options.worldHeight = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--input-seed") == 0 && i + 1 < argc) {
+            options.inputSeed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            options.configPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "scalar") == 0) SetKernelPath(KernelPath::SCALAR);
+            else if (std::strcmp(name, "sse2") == 0) SetKernelPath(KernelPath::SSE2);
+            else if (std::strcmp(name, "avx2") == 0) SetKernelPath(KernelPath::AVX2);
+            else return false;
+        } else if (std::strcmp(argv[i], "--check-kernels") == 0) {
+            options.checkKernels = true;
+        } else if (std::strcmp(argv[i], "--check-rollback") == 0) {
+            options.checkRollback = true;
+        } else if (std::strcmp(argv[i], "--check-sweep") == 0) {
+            options.checkSweep = true;
+        } else if (std::strcmp(argv[i], "--alloc-gate") == 0) {
+            options.allocGate = true;
+        } else if (std::strcmp(argv[i], "--frame-loop") == 0 && i + 1 < argc) {
+            options.frameLoopSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--draw-ms") == 0 && i + 1 < argc) {
+            options.drawMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--enemies") == 0 && i + 1 < argc) {
+            options.enemies = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            options.profilePath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return options.frames > 0 && options.deltaTime > 0.0f;
+}
+
+// Runs every supported integration kernel over the same random field, many
+// edge bounces included, and compares the results bit for bit with the scalar
+// kernel. Then sweeps the field, in shuffled candidate order, against a
+// moving circle on every path and compares the hit masks with SweepCircles.
+// Returns false if any path differs.
+static bool CheckKernels(const HeadlessOptions& options) {
+    const size_t count = 10007; // Not a multiple of any vector width, so tails run too
+    std::vector<float> x(count), y(count), speedX(count), speedY(count), size(count);
+    uint32_t state = options.inputSeed ? options.inputSeed : 1;
+    auto nextUnit = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    };
+    for (size_t i = 0; i < count; ++i) {
+        size[i] = 10.0f + nextUnit() * 40.0f;
+        x[i] = -20.0f + nextUnit() * (options.worldWidth + 20.0f);
+        y[i] = -20.0f + nextUnit() * (options.worldHeight + 20.0f);
+        speedX[i] = (nextUnit() - 0.5f) * 20.0f;
+        speedY[i] = (nextUnit() - 0.5f) * 20.0f;
+    }
+
+    const KernelPath previous = GetKernelPath();
+    std::vector<float> reference[4] = { x, y, speedX, speedY };
+    SetKernelPath(KernelPath::SCALAR);
+    for (int step = 0; step < 1000; ++step) {
+        IntegrateEnemies(reference[0].data(), reference[1].data(), reference[2].data(), reference[3].data(),
+                         size.data(), count, options.deltaTime, options.worldWidth, options.worldHeight);
+    }
+
+    bool allMatch = true;
+    for (KernelPath path : { KernelPath::SSE2, KernelPath::AVX2 }) {
+        if (static_cast<int>(path) > static_cast<int>(GetBestKernelPath())) {
+            std::printf("%-6s unsupported on this CPU\n", GetKernelPathName(path));
+            continue;
+        }
+        std::vector<float> result[4] = { x, y, speedX, speedY };
+        SetKernelPath(path);
+        for (int step = 0; step < 1000; ++step) {
+            IntegrateEnemies(result[0].data(), result[1].data(), result[2].data(), result[3].data(),
+                             size.data(), count, options.deltaTime, options.worldWidth, options.worldHeight);
+        }
+        bool match = true;
+        for (int column = 0; column < 4; ++column) {
+            match = match && std::memcmp(result[column].data(), reference[column].data(), count * sizeof(float)) == 0;
+        }
+        std::printf("%-6s integrate %s\n", GetKernelPathName(path), match ? "matches scalar" : "MISMATCH");
+        allMatch = allMatch && match;
+    }
+
+    // One long step so moves are large and many sweeps cross the circle
+    std::vector<float> endX = x, endY = y, endSpeedX = speedX, endSpeedY = speedY;
+    SetKernelPath(KernelPath::SCALAR);
+    IntegrateEnemies(endX.data(), endY.data(), endSpeedX.data(), endSpeedY.data(), size.data(), count,
+                     0.5f, options.worldWidth, options.worldHeight);
+    std::vector<uint32_t> candidates(count);
+    for (size_t i = 0; i < count; ++i) candidates[i] = static_cast<uint32_t>(i);
+    for (size_t i = count - 1; i > 0; --i) {
+        std::swap(candidates[i], candidates[static_cast<size_t>(nextUnit() * (i + 1))]);
+    }
+    const SweptCircle circle = { options.worldWidth / 2, options.worldHeight / 2, 40.0f, -25.0f, 75.0f };
+    std::vector<uint8_t> expected(count);
+    for (size_t k = 0; k < count; ++k) {
+        const uint32_t i = candidates[k];
+        const float radius = size[i] / 2;
+        float timeOfImpact;
+        expected[k] = SweepCircles({ circle.x, circle.y }, { circle.moveX, circle.moveY }, circle.radius,
+                                   { x[i] + radius, y[i] + radius }, { endX[i] - x[i], endY[i] - y[i] }, radius,
+                                   timeOfImpact) ? 1 : 0;
+    }
+    for (KernelPath path : { KernelPath::SCALAR, KernelPath::SSE2, KernelPath::AVX2 }) {
+        if (static_cast<int>(path) > static_cast<int>(GetBestKernelPath())) continue;
+        SetKernelPath(path);
+        std::vector<uint8_t> hits(count, 2);
+        const size_t hitCount = SweepEnemiesAgainstCircle(endX.data(), endY.data(), x.data(), y.data(), size.data(),
+                                                          candidates.data(), count, circle, hits.data());
+        size_t expectedCount = 0;
+        for (uint8_t hit : expected) expectedCount += hit;
+        const bool match = hits == expected && hitCount == expectedCount;
+        std::printf("%-6s sweep     %s (%zu of %zu hit)\n", GetKernelPathName(path),
+                    match ? "matches SweepCircles" : "MISMATCH", hitCount, count);
+        allMatch = allMatch && match;
+    }
+    SetKernelPath(previous);
+    return allMatch;
+}
+
+// FNV-1a over the state a replay should reproduce exactly, so two runs can be
+// compared from their output alone
+static uint64_t HashState(const Simulation& simulation) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t length) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    };
+
+    const int state = static_cast<int>(simulation.GetState());
+    const int score = simulation.GetScore();
+    const int playerHealth = simulation.GetPlayer().GetHealth();
+    const Rectangle player = simulation.GetPlayer().GetRectangle();
+    mix(&state, sizeof(state));
+    mix(&score, sizeof(score));
+    mix(&playerHealth, sizeof(playerHealth));
+    mix(&player, sizeof(player));
+
+    const EnemyStore& enemies = simulation.GetEnemies();
+    for (size_t i = 0; i < enemies.Count(); ++i) {
+        const Rectangle bounds = enemies.GetRectangle(i);
+        const int health = enemies.GetHealth(i);
+        mix(&bounds, sizeof(bounds));
+        mix(&health, sizeof(health));
+    }
+
+    const ProjectileStore& projectiles = simulation.GetProjectiles();
+    for (size_t order = 0; order < projectiles.Count(); ++order) {
+        const size_t slot = projectiles.Slot(order);
+        if (!projectiles.IsLive(slot)) continue;
+        const Vector2 position = projectiles.GetPosition(slot);
+        mix(&position, sizeof(position));
+    }
+    return hash;
+}
+
+// Plays the scripted game once to get an input sequence, then runs it again
+// through a rollback buffer that rewinds 40 steps every 50 and resimulates.
+// With the same input the result must match the straight run; with the
+// rewound step's attack flipped it must match a straight run of the flipped
+// sequence. Also reports what a snapshot costs next to a step.
+static bool CheckRollback(const HeadlessOptions& options) {
+    using Clock = std::chrono::steady_clock;
+    const size_t rewindInterval = 50;
+    const size_t rewindDistance = 40;
+
+    auto makeSimulation = [&options]() {
+        return std::make_unique<Simulation>(options.worldWidth, options.worldHeight, 4096, options.seed);
+    };
+    auto playStraight = [&](const std::vector<InputState>& inputs) {
+        std::unique_ptr<Simulation> simulation = makeSimulation();
+        for (const InputState& input : inputs) simulation->Step(options.deltaTime, input);
+        return HashState(*simulation);
+    };
+
+    std::vector<InputState> inputs;
+    inputs.reserve(static_cast<size_t>(options.frames));
+    {
+        std::unique_ptr<Simulation> simulation = makeSimulation();
+        ScriptedInput script(options.inputSeed);
+        for (long long frame = 0; frame < options.frames; ++frame) {
+            inputs.push_back(script.Next(simulation->GetState()));
+            simulation->Step(options.deltaTime, inputs.back());
+        }
+    }
+
+    bool allMatch = true;
+    for (bool correct : { false, true }) {
+        std::vector<InputState> played = inputs;
+        std::unique_ptr<Simulation> simulation = makeSimulation();
+        RollbackBuffer rollback(*simulation, 64);
+        double stepSeconds = 0.0;
+        for (size_t step = 0; step < played.size(); ++step) {
+            const Clock::time_point start = Clock::now();
+            rollback.Step(*simulation, options.deltaTime, played[step]);
+            stepSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (step % rewindInterval == rewindInterval - 1 && step >= rewindDistance) {
+                const size_t tick = step - rewindDistance;
+                if (correct) played[tick].buttons ^= INPUT_ATTACK;
+                if (!rollback.CorrectInput(*simulation, tick, played[tick])) {
+                    std::printf("rollback to tick %zu refused\n", tick);
+                    return false;
+                }
+            }
+        }
+
+        const bool match = HashState(*simulation) == playStraight(played);
+        std::printf("%-15s %s\n", correct ? "corrected input" : "same input",
+                    match ? "matches straight run" : "MISMATCH");
+        allMatch = allMatch && match;
+
+        if (!correct) {
+            // Time capture alone against the plain step it precedes
+            Snapshot snapshot;
+            simulation->SaveSnapshot(snapshot);
+            const int repeats = 1000;
+            const Clock::time_point start = Clock::now();
+            for (int i = 0; i < repeats; ++i) simulation->SaveSnapshot(snapshot);
+            const double captureNs = std::chrono::duration<double>(Clock::now() - start).count() * 1e9 / repeats;
+            std::printf("snapshot:       %zu bytes, %.0f ns (step with capture %.0f ns)\n",
+                        snapshot.Size(), captureNs, stepSeconds * 1e9 / played.size());
+        }
+    }
+    return allMatch;
+}
+
+// Plays one second of a single asteroid flying through the ship at
+// 300 px/s, with or without the attack held, and returns the player's health
+// and score. At 2 steps per second the asteroid jumps from 50 px short of the
+// ship's center to 100 px past it, so only a swept test sees the hit.
+static void PlayFlyThrough(const HeadlessOptions& options, int stepsPerSecond, bool attacking,
+                           int& health, int& score) {
+    Simulation simulation(options.worldWidth, options.worldHeight, 64, options.seed);
+    InputState start;
+    start.buttons = INPUT_START;
+    simulation.Step(1.0f / 60.0f, start);
+    simulation.GetEnemies().Clear();
+
+    const EntityConfig asteroid = { 30.0f, 0.0f, 1, Color{ 128, 128, 128, 255 } };
+    const Vector2 ship = simulation.GetPlayer().GetPosition();
+    simulation.GetEnemies().Spawn(asteroid, ship.x - 200.0f - 15.0f, ship.y - 15.0f, 5.0f, 0.0f);
+
+    InputState input;
+    if (attacking) input.buttons = INPUT_ATTACK;
+    for (int step = 0; step < stepsPerSecond; ++step) {
+        simulation.Step(1.0f / stepsPerSecond, input);
+    }
+    health = simulation.GetPlayer().GetHealth();
+    score = simulation.GetScore();
+}
+
+// A heavy and a light asteroid meeting off-center: after resolving they must
+// no longer overlap, and momentum and kinetic energy (mass going with area)
+// must be what they were
+static bool CheckAsteroidBounce(const HeadlessOptions& options) {
+    EnemyStore enemies;
+    enemies.SetCapacity(2);
+    enemies.ConfigureGrid(options.worldWidth, options.worldHeight, 100.0f);
+    const EntityConfig heavy = { 40.0f, 0.0f, 1, Color{ 128, 128, 128, 255 } };
+    const EntityConfig light = { 20.0f, 0.0f, 1, Color{ 128, 128, 128, 255 } };
+    enemies.Spawn(heavy, 300.0f, 300.0f, 2.0f, 0.5f);
+    enemies.Spawn(light, 335.0f, 315.0f, -3.0f, 0.0f);
+
+    auto totals = [&enemies](double& momentumX, double& momentumY, double& energy) {
+        momentumX = momentumY = energy = 0.0;
+        for (size_t i = 0; i < enemies.Count(); ++i) {
+            const double mass = enemies.GetRectangle(i).width * enemies.GetRectangle(i).width;
+            const Vector2 speed = enemies.GetSpeed(i);
+            momentumX += mass * speed.x;
+            momentumY += mass * speed.y;
+            energy += 0.5 * mass * (speed.x * speed.x + speed.y * speed.y);
+        }
+    };
+
+    double beforeX, beforeY, beforeEnergy, afterX, afterY, afterEnergy;
+    totals(beforeX, beforeY, beforeEnergy);
+    FrameArena arena("check");
+    enemies.ResolveCollisions(options.worldWidth, options.worldHeight, arena);
+    totals(afterX, afterY, afterEnergy);
+
+    const Rectangle a = enemies.GetRectangle(0);
+    const Rectangle b = enemies.GetRectangle(1);
+    const float dx = (b.x + b.width * 0.5f) - (a.x + a.width * 0.5f);
+    const float dy = (b.y + b.height * 0.5f) - (a.y + a.height * 0.5f);
+    const float reach = (a.width + b.width) * 0.5f;
+    const bool separated = dx * dx + dy * dy >= reach * reach * 0.9999f;
+    const bool bounced = enemies.GetSpeed(1).x > 0.0f;
+    return separated && bounced &&
+           std::fabs(afterX - beforeX) < 1e-3 * std::fabs(beforeX) + 1e-3 &&
+           std::fabs(afterY - beforeY) < 1e-3 * std::fabs(beforeY) + 1e-3 &&
+           std::fabs(afterEnergy - beforeEnergy) < 1e-4 * beforeEnergy;
+}
+
+// Known answers for the swept tests, then the fly-through at two tick rates,
+// which must agree
+static bool CheckSweep(const HeadlessOptions& options) {
+    bool allPass = true;
+    auto report = [&allPass](const char* name, bool pass) {
+        std::printf("%-28s %s\n", name, pass ? "ok" : "FAILED");
+        allPass = allPass && pass;
+    };
+
+    float t = -1.0f;
+    report("circles head-on", SweepCircles({ 0, 0 }, { 0, 0 }, 10, { 100, 0 }, { -200, 0 }, 10, t) &&
+                              std::fabs(t - 0.4f) < 1e-6f);
+    report("circles passing through", SweepCircles({ 0, 0 }, { 0, 0 }, 10, { 100, 0 }, { -400, 0 }, 10, t) &&
+                                      std::fabs(t - 0.2f) < 1e-6f);
+    report("circles both moving", SweepCircles({ 0, 0 }, { 50, 0 }, 10, { 100, 0 }, { -50, 0 }, 10, t) &&
+                                  std::fabs(t - 0.8f) < 1e-6f);
+    report("circles grazing", !SweepCircles({ 0, 0 }, { 0, 0 }, 10, { -100, 20 }, { 200, 0 }, 10, t));
+    report("circles overlapping", SweepCircles({ 0, 0 }, { 0, 0 }, 10, { 5, 0 }, { 100, 0 }, 10, t) && t == 0.0f);
+    report("circles separating", !SweepCircles({ 0, 0 }, { 0, 0 }, 10, { 30, 0 }, { 100, 0 }, 10, t));
+    report("circle-rect edge", SweepCircleRect({ -50, 5 }, { 100, 0 }, 10, { 0, 0, 20, 20 }, t) &&
+                               std::fabs(t - 0.4f) < 1e-6f);
+    report("circle-rect corner", SweepCircleRect({ -20, -20 }, { 20, 20 }, 10, { 0, 0, 20, 20 }, t) &&
+                                 std::fabs(t - (1.0f - 10.0f / std::sqrt(800.0f))) < 1e-5f);
+    report("circle-rect corner miss", !SweepCircleRect({ -20, 5 }, { 25, -25 }, 10, { 0, 0, 20, 20 }, t));
+    report("circle-rect through", SweepCircleRect({ -100, 10 }, { 300, 0 }, 5, { 0, 0, 20, 20 }, t) &&
+                                  std::fabs(t - 95.0f / 300.0f) < 1e-6f);
+
+    for (bool attacking : { false, true }) {
+        int fastHealth = 0, fastScore = 0, slowHealth = 0, slowScore = 0;
+        PlayFlyThrough(options, 60, attacking, fastHealth, fastScore);
+        PlayFlyThrough(options, 2, attacking, slowHealth, slowScore);
+        const bool expected = attacking ? fastScore > 0 : fastHealth < 3;
+        char name[64];
+        std::snprintf(name, sizeof(name), "fly-through, %s", attacking ? "attacking" : "idle");
+        report(name, expected && fastHealth == slowHealth && fastScore == slowScore);
+    }
+    report("asteroid bounce", CheckAsteroidBounce(options));
+    return allPass;
+}
+
+// Plays scripted games and fails if any step that starts and ends in the
+// playing state touches the heap. The first steps are left out, since arenas
+// may still be growing to fit the busiest step; restarts and wave changes in
+// between are fine, but the steps around them are checked like the rest.
+static bool CheckAllocations(const HeadlessOptions& options) {
+    if (!AllocTracker::IsInstalled()) {
+        std::printf("allocation hooks aren't linked in\n");
+        return false;
+    }
+
+    const long long warmup = 600;
+    Simulation simulation(options.worldWidth, options.worldHeight, 4096, options.seed);
+    JobSystem jobs(options.threads);
+    simulation.SetJobSystem(&jobs);
+    ScriptedInput script(options.inputSeed);
+
+    long long checkedSteps = 0;
+    long long allocatingSteps = 0;
+    uint64_t allocations = 0;
+    for (long long frame = 0; frame < options.frames; ++frame) {
+        const InputState input = script.Next(simulation.GetState());
+        const bool wasPlaying = simulation.GetState() == GameState::PLAYING;
+        AllocTracker::EndFrame();
+        simulation.Step(options.deltaTime, input);
+        AllocTracker::EndFrame();
+        if (frame < warmup || !wasPlaying || simulation.GetState() != GameState::PLAYING) continue;
+
+        checkedSteps++;
+        const AllocCounts counts = AllocTracker::GetLastFrame();
+        if (counts.allocations == 0) continue;
+        allocations += counts.allocations;
+        if (allocatingSteps++ < 5) {
+            std::printf("step %lld: %llu allocations, %llu bytes\n", frame,
+                        static_cast<unsigned long long>(counts.allocations),
+                        static_cast<unsigned long long>(counts.allocatedBytes));
+            for (int i = 0; i < AllocTracker::GetScopeCount(); ++i) {
+                const AllocScopeStats scope = AllocTracker::GetScope(i);
+                if (scope.lastFrame.allocations == 0) continue;
+                std::printf("  %-24s %llu\n", scope.name, static_cast<unsigned long long>(scope.lastFrame.allocations));
+            }
+        }
+    }
+
+    std::printf("playing steps:  %lld checked\n", checkedSteps);
+    std::printf("allocating:     %lld steps, %llu allocations\n", allocatingSteps,
+                static_cast<unsigned long long>(allocations));
+    return checkedSteps > 0 && allocatingSteps == 0;
+}
+
+// What one game loop managed in a --frame-loop run
+struct FrameLoopStats {
+    long long frames = 0;
+    long long lateFrames = 0; // Missed a display refresh
+    uint64_t steps = 0;
+    long long latencySamples = 0;
+    double latencySum = 0.0;  // Input sample to present, ms
+    double latencyMax = 0.0;
+    double seconds = 0.0;
+};
+
+// Stands in for the window side of a frame: spins for the draw's CPU time,
+// then waits for the next refresh of a 60 Hz display as a vsynced present
+// would. Returns the present time.
+static int64_t DrawAndPresent(int64_t drawNanoseconds, int64_t displayStart, int64_t& lastPresent,
+                              FrameLoopStats& stats) {
+    const int64_t refresh = 1000000000LL / 60;
+    const int64_t drawEnd = Profiler::Now() + drawNanoseconds;
+    while (Profiler::Now() < drawEnd) {}
+
+    const int64_t vsync = displayStart + ((Profiler::Now() - displayStart) / refresh + 1) * refresh;
+    std::this_thread::sleep_for(std::chrono::nanoseconds(vsync - Profiler::Now()));
+    if (lastPresent > 0 && vsync - lastPresent > refresh) stats.lateFrames++;
+    lastPresent = vsync;
+    stats.frames++;
+    return vsync;
+}
+
+static void RecordLatency(const RenderState& state, int64_t present, FrameLoopStats& stats) {
+    if (state.inputTime <= 0) return;
+    const double ms = (present - state.inputTime) / 1e6;
+    stats.latencySum += ms;
+    stats.latencyMax = ms > stats.latencyMax ? ms : stats.latencyMax;
+    stats.latencySamples++;
+}
+
+// Game::Run's two loops with the window replaced by DrawAndPresent and the
+// keyboard by scripted input: serial steps and draws on one thread, threaded
+// steps on a SimulationThread while this one draws whatever it published.
+// With --enemies the field is topped up between steps so steps stay heavy.
+static FrameLoopStats RunFrameLoop(const HeadlessOptions& options, bool threaded) {
+    Simulation simulation(options.worldWidth, options.worldHeight, 4096, options.seed);
+    JobSystem jobs(options.threads);
+    simulation.SetJobSystem(&jobs);
+    ScriptedInput script(options.inputSeed);
+    const int tickRate = static_cast<int>(1.0f / options.deltaTime + 0.5f);
+    const int64_t tickNanoseconds = 1000000000LL / tickRate;
+    const int64_t drawNanoseconds = static_cast<int64_t>(options.drawMs * 1e6);
+    const int maxSteps = 5;
+
+    auto topUp = [&]() {
+        const int count = static_cast<int>(simulation.GetEnemies().Count());
+        if (simulation.GetState() == GameState::PLAYING && count < options.enemies) {
+            simulation.SpawnEnemies(options.enemies - count);
+        }
+    };
+
+    FrameLoopStats stats;
+    const int64_t begin = Profiler::Now();
+    const int64_t end = begin + static_cast<int64_t>(options.frameLoopSeconds * 1e9);
+    int64_t lastPresent = 0;
+
+    if (threaded) {
+        SimulationThread simulationThread(simulation, nullptr, nullptr, tickRate, maxSteps);
+        simulationThread.SetInputFilter([&](const InputState&) { return script.Next(simulation.GetState()); });
+        simulationThread.SetBetweenSteps(topUp);
+        simulationThread.Start();
+        while (Profiler::Now() < end) {
+            simulationThread.SubmitInput(InputState(), Profiler::Now());
+            const RenderState* state = simulationThread.FetchState();
+            const int64_t present = DrawAndPresent(drawNanoseconds, begin, lastPresent, stats);
+            if (state) RecordLatency(*state, present, stats);
+        }
+        simulationThread.Stop();
+        stats.steps = simulationThread.GetStepCount();
+    } else {
+        RenderState state;
+        int64_t accumulator = 0;
+        int64_t last = Profiler::Now();
+        while (Profiler::Now() < end) {
+            const int64_t sampleTime = Profiler::Now();
+            accumulator += sampleTime - last;
+            last = sampleTime;
+
+            int steps = 0;
+            while (accumulator >= tickNanoseconds && steps < maxSteps) {
+                topUp();
+                simulation.Step(options.deltaTime, script.Next(simulation.GetState()));
+                accumulator -= tickNanoseconds;
+                steps++;
+            }
+            if (steps == maxSteps && accumulator >= tickNanoseconds) accumulator = 0;
+            stats.steps += static_cast<uint64_t>(steps);
+
+            state.Capture(simulation, nullptr);
+            if (steps > 0) state.inputTime = sampleTime;
+            RecordLatency(state, DrawAndPresent(drawNanoseconds, begin, lastPresent, stats), stats);
+        }
+    }
+    stats.seconds = (Profiler::Now() - begin) / 1e9;
+    return stats;
+}
+
+static void CompareFrameLoops(const HeadlessOptions& options) {
+    std::printf("draw %.1f ms per frame, 60 Hz display, %d steps/s, at least %d enemies\n", options.drawMs,
+                static_cast<int>(1.0f / options.deltaTime + 0.5f), options.enemies);
+    std::printf("loop      frames/s   steps/s   latency mean   latency max   late frames\n");
+    for (bool threaded : { false, true }) {
+        const FrameLoopStats stats = RunFrameLoop(options, threaded);
+        std::printf("%-9s %8.1f %9.1f %11.1f ms %10.1f ms %13lld\n", threaded ? "threaded" : "serial",
+                    stats.frames / stats.seconds, stats.steps / stats.seconds,
+                    stats.latencySamples > 0 ? stats.latencySum / stats.latencySamples : 0.0, stats.latencyMax,
+                    stats.lateFrames);
+    }
+}
+
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.checkKernels) {
+        return CheckKernels(options) ? 0 : 1;
+    }
+    if (options.checkSweep) {
+        return CheckSweep(options) ? 0 : 1;
+    }
+    if (options.checkRollback) {
+        return CheckRollback(options) ? 0 : 1;
+    }
+    if (options.allocGate) {
+        return CheckAllocations(options) ? 0 : 1;
+    }
+    if (options.frameLoopSeconds > 0.0) {
+        CompareFrameLoops(options);
+        return 0;
+    }
+
+    InputLog replay;
+    if (options.replayPath) {
+        if (!replay.Load(options.replayPath)) {
+            std::fprintf(stderr, "Could not load replay %s\n", options.replayPath);
+            return 1;
+        }
+        options.seed = replay.GetSeed();
+        options.deltaTime = 1.0f / replay.GetTickRate();
+        options.worldWidth = replay.GetWorldWidth();
+        options.worldHeight = replay.GetWorldHeight();
+        options.frames = static_cast<long long>(replay.Size());
+    }
+
+    Simulation simulation(options.worldWidth, options.worldHeight, 4096, options.seed);
+    JobSystem jobs(options.threads);
+    simulation.SetJobSystem(&jobs);
+    if (options.configPath) {
+        auto config = std::make_unique<ConfigManager>();
+        std::string error;
+        if (!config->LoadFromFile(options.configPath, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        simulation.SetConfig(std::move(config));
+    }
+    ScriptedInput script(options.inputSeed);
+    InputLog record(options.seed, static_cast<int>(1.0f / options.deltaTime + 0.5f),
+                    options.worldWidth, options.worldHeight);
+
+    int gamesFinished = 0;
+    int bestScore = 0;
+    GameState previousState = simulation.GetState();
+
+    Profiler::SetEnabled(options.profilePath != nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long long frame = 0; frame < options.frames; ++frame) {
+        Profiler::BeginFrame();
+        InputState input = options.replayPath ? replay.Get(static_cast<size_t>(frame))
+                                              : script.Next(simulation.GetState());
+        if (options.recordPath) record.Append(input);
+        simulation.Step(options.deltaTime, input);
+        Profiler::EndFrame();
+
+        GameState state = simulation.GetState();
+        if (state != previousState && (state == GameState::GAME_OVER || state == GameState::VICTORY)) {
+            gamesFinished++;
+            if (simulation.GetScore() > bestScore) bestScore = simulation.GetScore();
+        }
+        previousState = state;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("kernel:         %s\n", GetKernelPathName(GetKernelPath()));
+    std::printf("threads:        %zu\n", jobs.GetThreadCount());
+    std::printf("steps:          %lld\n", options.frames);
+    std::printf("elapsed:        %.3f s\n", seconds);
+    std::printf("steps/second:   %.0f\n", seconds > 0.0 ? options.frames / seconds : 0.0);
+    std::printf("games finished: %d\n", gamesFinished);
+    std::printf("best score:     %d\n", bestScore);
+    std::printf("final score:    %d\n", simulation.GetScore());
+    std::printf("state hash:     %016llx\n", static_cast<unsigned long long>(HashState(simulation)));
+
+    if (options.recordPath && !record.Save(options.recordPath)) {
+        std::fprintf(stderr, "Could not write %s\n", options.recordPath);
+        return 1;
+    }
+
+    if (options.profilePath) {
+        if (!Profiler::ExportChromeTrace(options.profilePath)) {
+            std::fprintf(stderr, "Could not write %s\n", options.profilePath);
+            return 1;
+        }
+        std::printf("trace:          %s (%d steps)\n", options.profilePath, Profiler::GetFrameCount());
+    }
+#ifdef ASTEROIDS_ALLOC_TRACKING
+    AllocTracker::Report(stdout);
+#endif
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "input_log.h"
+#include <cstdio>
+#include <cstring>
+
+static const char logMagic[4] = { 'A', 'S', 'T', 'I' };
+static const uint32_t logVersion = 1;
+
+// Fixed-width little endian fields, so logs move between machines
+static void PutU32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static void PutU64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static uint32_t GetU32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return value;
+}
+
+static uint64_t GetU64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+static uint32_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float BitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static const size_t headerSize = 4 + 4 + 8 + 4 + 4 + 4 + 4;
+
+InputLog::InputLog() : seed(1), tickRate(60), worldWidth(800.0f), worldHeight(600.0f) {}
+
+InputLog::InputLog(uint64_t seed, int tickRate, float worldWidth, float worldHeight)
+    : seed(seed), tickRate(tickRate), worldWidth(worldWidth), worldHeight(worldHeight) {}
+
+void InputLog::Append(const InputState& input) {
+    ticks.push_back(input.buttons);
+}
+
+void InputLog::Clear() {
+    ticks.clear();
+}
+
+size_t InputLog::Size() const {
+    return ticks.size();
+}
+
+InputState InputLog::Get(size_t tick) const {
+    InputState input;
+    input.buttons = ticks[tick];
+    return input;
+}
+
+uint64_t InputLog::GetSeed() const {
+    return seed;
+}
+
+int InputLog::GetTickRate() const {
+    return tickRate;
+}
+
+float InputLog::GetWorldWidth() const {
+    return worldWidth;
+}
+
+float InputLog::GetWorldHeight() const {
+    return worldHeight;
+}
+
+bool InputLog::Save(const std::string& path) const {
+    std::vector<uint8_t> data;
+    data.reserve(headerSize + ticks.size());
+    data.insert(data.end(), logMagic, logMagic + 4);
+    PutU32(data, logVersion);
+    PutU64(data, seed);
+    PutU32(data, static_cast<uint32_t>(tickRate));
+    PutU32(data, FloatBits(worldWidth));
+    PutU32(data, FloatBits(worldHeight));
+    PutU32(data, static_cast<uint32_t>(ticks.size()));
+    data.insert(data.end(), ticks.begin(), ticks.end());
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && written;
+}
+
+bool InputLog::Load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    std::fclose(file);
+
+    if (data.size() < headerSize || std::memcmp(data.data(), logMagic, 4) != 0 ||
+        GetU32(data.data() + 4) != logVersion) {
+        return false;
+    }
+    const uint32_t tickCount = GetU32(data.data() + 28);
+    if (data.size() - headerSize != tickCount) return false;
+
+    seed = GetU64(data.data() + 8);
+    tickRate = static_cast<int>(GetU32(data.data() + 16));
+    worldWidth = BitsFloat(GetU32(data.data() + 20));
+    worldHeight = BitsFloat(GetU32(data.data() + 24));
+    ticks.assign(data.begin() + headerSize, data.end());
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include "simulation.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Everything needed to replay a session: the simulation seed, step rate and
+// world size, then one InputState bitmask per simulation step from the first.
+//
+// File layout (little endian): "ASTI", uint32 version, uint64 seed,
+// uint32 tickRate, float worldWidth, float worldHeight, uint32 tick count,
+// then one byte per tick.
+class InputLog {
+public:
+    InputLog();
+    InputLog(uint64_t seed, int tickRate, float worldWidth, float worldHeight);
+
+    void Append(const InputState& input);
+    void Clear();
+
+    size_t Size() const;
+    InputState Get(size_t tick) const;
+    uint64_t GetSeed() const;
+    int GetTickRate() const;
+    float GetWorldWidth() const;
+    float GetWorldHeight() const;
+
+    bool Save(const std::string& path) const;
+    // Returns false and leaves the log unchanged if the file is missing or malformed
+    bool Load(const std::string& path);
+
+private:
+    uint64_t seed;
+    int tickRate;
+    float worldWidth;
+    float worldHeight;
+    std::vector<uint8_t> ticks;
+};
+
+#endif // INPUT_LOG_H
@@ -0,0 +1,140 @@
+#include "job_system.h"
+
+JobSystem::JobSystem(size_t threadCount)
+    : taskFunction(nullptr),
+      taskContext(nullptr),
+      pendingJobs(0),
+      stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 1;
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    threads.reserve(threadCount - 1);
+    for (size_t queue = 1; queue < threadCount; ++queue) {
+        threads.emplace_back(&JobSystem::WorkerLoop, this, queue);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t JobSystem::GetThreadCount() const {
+    return queues.size();
+}
+
+size_t JobSystem::GetChunkCount(size_t count, size_t grainSize) {
+    if (grainSize == 0) grainSize = 1;
+    return (count + grainSize - 1) / grainSize;
+}
+
+void JobSystem::Run(size_t count, size_t grainSize, TaskFunction function, const void* context) {
+    if (count == 0) return;
+    if (grainSize == 0) grainSize = 1;
+
+    // Nothing to share out; skip the queues entirely
+    const size_t chunkCount = GetChunkCount(count, grainSize);
+    if (queues.size() == 1 || chunkCount == 1) {
+        for (size_t begin = 0; begin < count; begin += grainSize) {
+            function(context, begin, begin + grainSize < count ? begin + grainSize : count);
+        }
+        return;
+    }
+
+    // Deal contiguous runs of chunks to each queue, so each thread starts on
+    // neighbouring memory and only steals once its own share is done
+    taskFunction = function;
+    taskContext = context;
+    pendingJobs.store(chunkCount, std::memory_order_relaxed);
+    const size_t queueCount = queues.size();
+    for (size_t queue = 0; queue < queueCount; ++queue) {
+        const size_t firstChunk = chunkCount * queue / queueCount;
+        const size_t lastChunk = chunkCount * (queue + 1) / queueCount;
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        // Pushed in reverse so the owner, popping from the back, walks forwards
+        for (size_t chunk = lastChunk; chunk-- > firstChunk;) {
+            const size_t begin = chunk * grainSize;
+            queues[queue]->jobs.push_back({ begin, begin + grainSize < count ? begin + grainSize : count });
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+
+    // The caller works too, then waits for chunks still running elsewhere
+    Job job;
+    while (pendingJobs.load(std::memory_order_acquire) > 0) {
+        if (TakeJob(0, job)) {
+            function(context, job.begin, job.end);
+            pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    taskFunction = nullptr;
+    taskContext = nullptr;
+}
+
+bool JobSystem::TakeJob(size_t queue, Job& job) {
+    {
+        WorkQueue& own = *queues[queue];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.jobs.size() > own.front) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            if (own.jobs.size() == own.front) {
+                own.jobs.clear();
+                own.front = 0;
+            }
+            return true;
+        }
+    }
+
+    // Steal the oldest chunk from the next queue that has any
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = *queues[(queue + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.size() > victim.front) {
+            job = victim.jobs[victim.front++];
+            if (victim.jobs.size() == victim.front) {
+                victim.jobs.clear();
+                victim.front = 0;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::WorkerLoop(size_t queue) {
+    Job job;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || pendingJobs.load(std::memory_order_acquire) > 0; });
+            if (stopping) return;
+        }
+
+        // Keep taking chunks until the whole loop is done, so a thread that
+        // drains early doesn't go back to sleep while others could use help
+        while (pendingJobs.load(std::memory_order_acquire) > 0) {
+            if (TakeJob(queue, job)) {
+                taskFunction(taskContext, job.begin, job.end);
+                pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing job system for data-parallel loops. Every thread, the caller
+// of ParallelFor included, has its own queue of chunks. It works from the
+// back of its own queue and, once that runs dry, steals from the front of
+// the others, so uneven chunks balance out across the threads.
+//
+// ParallelFor only returns once every chunk ran, and chunk boundaries depend
+// only on count and grain size, so callers that write per-chunk results and
+// combine them in chunk order get the same answer on any thread count.
+class JobSystem {
+public:
+    // threadCount includes the calling thread; 0 uses every hardware thread,
+    // 1 runs everything inline on the caller
+    explicit JobSystem(size_t threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    size_t GetThreadCount() const;
+
+    // Number of chunks ParallelFor splits count items into
+    static size_t GetChunkCount(size_t count, size_t grainSize);
+
+    // Runs task(begin, end) over [0, count) in chunks of grainSize items (the
+    // last one may be shorter). Only one ParallelFor may run at a time, and
+    // tasks must not start another. The task is called through a pointer
+    // rather than copied into a std::function, and the queues keep their
+    // capacity, so a ParallelFor doesn't allocate once the queues have grown.
+    template<typename Task>
+    void ParallelFor(size_t count, size_t grainSize, const Task& task) {
+        Run(count, grainSize, [](const void* context, size_t begin, size_t end) {
+            (*static_cast<const Task*>(context))(begin, end);
+        }, &task);
+    }
+
+private:
+    using TaskFunction = void (*)(const void* context, size_t begin, size_t end);
+
+    struct Job {
+        size_t begin;
+        size_t end;
+    };
+
+    // Filled at the back before a loop starts; the owner pops from the back,
+    // thieves from `front`
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        size_t front = 0;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues; // Queue 0 belongs to the calling thread
+    std::vector<std::thread> threads;
+    TaskFunction taskFunction;
+    const void* taskContext;
+    std::atomic<size_t> pendingJobs;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void Run(size_t count, size_t grainSize, TaskFunction function, const void* context);
+    bool TakeJob(size_t queue, Job& job);
+    void WorkerLoop(size_t queue);
+};
+
+#endif // JOB_SYSTEM_H
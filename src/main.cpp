@@ -1,11 +1,52 @@
 #include "game.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-int main() {
+int main(int argc, char** argv) {
     const int screenWidth = 800;
     const int screenHeight = 600;
 
-    Game game(screenWidth, screenHeight);
+    // --seed N fixes the game's randomness, --record PATH saves this session's
+    // input for replay, --replay PATH plays one back, --config PATH plays with
+    // (and hot reloads) a compiled config, --serial steps the simulation on the
+    // window thread instead of its own
+    uint64_t seed = 0;
+    bool serial = false;
+    const char* configPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--serial") == 0) {
+            serial = true;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--seed N] [--config PATH] [--record PATH] [--replay PATH] [--serial]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Game game(screenWidth, screenHeight, 60, seed);
+    game.UseSimulationThread(!serial);
+    if (replayPath && !game.ReplayFrom(replayPath)) {
+        std::fprintf(stderr, "Could not load replay %s\n", replayPath);
+        return 1;
+    }
+    // After the replay, which starts a fresh simulation
+    if (configPath && !game.LoadConfig(configPath)) {
+        return 1;
+    }
+    if (recordPath) {
+        game.RecordTo(recordPath);
+    }
     game.Run();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,98 @@
+#include "particles.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+
+// One contiguous run of particles. Plain arithmetic, so the compiler
+// vectorizes it.
+static void IntegrateParticles(float* x, float* y, float* velocityX, float* velocityY, float* age,
+                               const float* inverseLifetime, float* fade, size_t count,
+                               float deltaTime, float drag) {
+    for (size_t i = 0; i < count; ++i) {
+        x[i] += velocityX[i] * deltaTime;
+        y[i] += velocityY[i] * deltaTime;
+        velocityX[i] *= drag;
+        velocityY[i] *= drag;
+        age[i] += deltaTime;
+        fade[i] = std::max(0.0f, 1.0f - age[i] * inverseLifetime[i]);
+    }
+}
+
+ParticleSystem::ParticleSystem(size_t budget) : head(0), count(0), mask(0), emittedSinceUpdate(0), random(0x5eed) {
+    size_t capacity = 1;
+    while (capacity < budget) capacity <<= 1;
+
+    x.assign(capacity, 0.0f);
+    y.assign(capacity, 0.0f);
+    velocityX.assign(capacity, 0.0f);
+    velocityY.assign(capacity, 0.0f);
+    age.assign(capacity, 0.0f);
+    inverseLifetime.assign(capacity, 0.0f);
+    fade.assign(capacity, 0.0f);
+    size.assign(capacity, 0.0f);
+    color.assign(capacity, Color{ 0, 0, 0, 0 });
+    mask = capacity - 1;
+}
+
+void ParticleSystem::Emit(const ParticleBurst& burst) {
+    const size_t capacity = x.size();
+    const size_t allowed = capacity - std::min(emittedSinceUpdate, capacity);
+    const size_t emitting = std::min(static_cast<size_t>(std::max(burst.count, 0)), allowed);
+    emittedSinceUpdate += emitting;
+
+    for (size_t i = 0; i < emitting; ++i) {
+        // A full ring overwrites its oldest particle
+        if (count == capacity) {
+            head = (head + 1) & mask;
+            count--;
+        }
+        const size_t slot = (head + count) & mask;
+        count++;
+
+        const float angle = burst.direction + random.NextFloat(-0.5f, 0.5f) * burst.spread;
+        const float speed = burst.speed * random.NextFloat(0.25f, 1.0f);
+        x[slot] = burst.position.x;
+        y[slot] = burst.position.y;
+        velocityX[slot] = burst.velocity.x + std::cos(angle) * speed;
+        velocityY[slot] = burst.velocity.y + std::sin(angle) * speed;
+        age[slot] = 0.0f;
+        inverseLifetime[slot] = 1.0f / (burst.lifetime * random.NextFloat(0.5f, 1.5f));
+        fade[slot] = 1.0f;
+        size[slot] = burst.size;
+        color[slot] = burst.color;
+    }
+}
+
+void ParticleSystem::Update(float deltaTime) {
+    PROFILE_SCOPE("particles_update");
+
+    emittedSinceUpdate = 0;
+    const float drag = std::pow(0.2f, deltaTime); // Down to a fifth of the speed per second
+    const size_t first = std::min(count, x.size() - head);
+    IntegrateParticles(x.data() + head, y.data() + head, velocityX.data() + head, velocityY.data() + head,
+                       age.data() + head, inverseLifetime.data() + head, fade.data() + head, first,
+                       deltaTime, drag);
+    IntegrateParticles(x.data(), y.data(), velocityX.data(), velocityY.data(), age.data(),
+                       inverseLifetime.data(), fade.data(), count - first, deltaTime, drag);
+
+    // Lifetimes vary, so particles that expire behind a longer-lived one are
+    // only dropped once the head gets to them; until then they draw nothing
+    while (count > 0 && fade[head] <= 0.0f) {
+        head = (head + 1) & mask;
+        count--;
+    }
+}
+
+void ParticleSystem::Clear() {
+    head = 0;
+    count = 0;
+    emittedSinceUpdate = 0;
+}
+
+size_t ParticleSystem::Count() const {
+    return count;
+}
+
+size_t ParticleSystem::GetBudget() const {
+    return x.size();
+}
@@ -0,0 +1,70 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "core_types.h"
+#include "random.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// One emission: count particles thrown from a point within spread radians
+// of direction (a full turn throws them all round), at up to speed on top of
+// the emitter's own velocity. Speeds are pixels per second; lifetimes vary
+// by up to half either way.
+struct ParticleBurst {
+    Vector2 position;
+    Vector2 velocity;
+    float direction;
+    float spread;
+    int count;
+    float speed;
+    float lifetime;
+    float size;
+    Color color;
+};
+
+// Cosmetic particles (explosions, sparks, thrust) under a hard budget. They
+// live in a ring of structure-of-arrays columns: emitting into a full ring
+// drops the oldest particles, and the frame's emissions stop once they add
+// up to the budget, so however many rocks blow up at once a frame costs at
+// most one budget's worth of emitting, integrating and drawing.
+//
+// Advanced with the frame time rather than the simulation step. Particles are
+// never read back by the simulation and have their own random generator, so
+// they don't affect gameplay or determinism.
+class ParticleSystem {
+public:
+    // Rounded up to a power of two
+    explicit ParticleSystem(size_t budget = 8192);
+
+    void Emit(const ParticleBurst& burst);
+    // Moves, slows and fades every particle in one pass and drops the
+    // expired ones from the head
+    void Update(float deltaTime);
+    void Clear();
+    // Every particle as a fading quad in one batched submission. Implemented
+    // by the renderer (game.cpp)
+    void Draw() const;
+
+    // Ring entries in use, expired ones not yet dropped included
+    size_t Count() const;
+    size_t GetBudget() const;
+
+private:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> age;
+    std::vector<float> inverseLifetime;
+    std::vector<float> fade;     // 1 when emitted, 0 once expired
+    std::vector<float> size;
+    std::vector<Color> color;
+    size_t head;                 // Oldest particle
+    size_t count;
+    size_t mask;                 // Budget - 1
+    size_t emittedSinceUpdate;
+    Random random;
+};
+
+#endif // PARTICLES_H
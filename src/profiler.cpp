@@ -0,0 +1,99 @@
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+
+static ProfileFrame frames[Profiler::MAX_FRAMES];
+static int writeIndex = 0;     // Slot the current frame records into
+static int completedFrames = 0;
+// Per thread, so scopes on threads that didn't call BeginFrame (job workers,
+// the simulation thread) are skipped instead of racing into the frame
+static thread_local bool inFrame = false;
+static thread_local uint32_t currentDepth = 0;
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+int64_t Profiler::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::SetEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void Profiler::BeginFrame() {
+    if (!enabled) return;
+
+    ProfileFrame& frame = frames[writeIndex];
+    frame.start = Now();
+    frame.end = frame.start;
+    frame.eventCount = 0;
+    frame.droppedEvents = 0;
+    currentDepth = 0;
+    inFrame = true;
+}
+
+void Profiler::EndFrame() {
+    if (!inFrame) return;
+
+    frames[writeIndex].end = Now();
+    writeIndex = (writeIndex + 1) % MAX_FRAMES;
+    if (completedFrames < MAX_FRAMES) completedFrames++;
+    inFrame = false;
+}
+
+int Profiler::BeginScope(const char* name) {
+    if (!inFrame) return -1;
+
+    ProfileFrame& frame = frames[writeIndex];
+    if (frame.eventCount >= ProfileFrame::MAX_EVENTS) {
+        frame.droppedEvents++;
+        return -1;
+    }
+
+    int index = frame.eventCount++;
+    ProfileEvent& event = frame.events[index];
+    event.name = name;
+    event.depth = currentDepth++;
+    event.start = Now();
+    event.end = event.start;
+    return index;
+}
+
+void Profiler::EndScope(int eventIndex) {
+    if (!inFrame) return;
+
+    frames[writeIndex].events[eventIndex].end = Now();
+    if (currentDepth > 0) currentDepth--;
+}
+
+int Profiler::GetFrameCount() {
+    return completedFrames;
+}
+
+const ProfileFrame& Profiler::GetFrame(int age) {
+    int index = (writeIndex - 1 - age) % MAX_FRAMES;
+    if (index < 0) index += MAX_FRAMES;
+    return frames[index];
+}
+
+bool Profiler::ExportChromeTrace(const char* path) {
+    std::FILE* out = std::fopen(path, "w");
+    if (!out) return false;
+
+    // Complete ("X") events with microsecond timestamps, oldest frame first
+    std::fprintf(out, "{\"traceEvents\": [\n");
+    bool first = true;
+    for (int age = completedFrames - 1; age >= 0; --age) {
+        const ProfileFrame& frame = GetFrame(age);
+        std::fprintf(out, "%s{\"name\": \"frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f}",
+                     first ? "" : ",\n", frame.start / 1000.0, (frame.end - frame.start) / 1000.0);
+        first = false;
+        for (int i = 0; i < frame.eventCount; ++i) {
+            const ProfileEvent& event = frame.events[i];
+            std::fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f}",
+                         event.name, event.start / 1000.0, (event.end - event.start) / 1000.0);
+        }
+    }
+    std::fprintf(out, "\n], \"displayTimeUnit\": \"ms\"}\n");
+    return std::fclose(out) == 0;
+}
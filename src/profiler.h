@@ -0,0 +1,87 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "alloc_tracker.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Lightweight frame profiler. PROFILE_SCOPE records how long a block took into
+// the current frame; the last MAX_FRAMES frames are kept in a ring buffer for
+// the on-screen overlay and for Chrome trace export (chrome://tracing or
+// https://ui.perfetto.dev).
+//
+// Scopes are compiled in when ASTEROIDS_PROFILER is defined. While recording
+// is disabled a scope costs one predictable branch. Only scopes on the thread
+// that calls BeginFrame/EndFrame are recorded; other threads' are skipped.
+// With ASTEROIDS_ALLOC_TRACKING each scope also counts its heap allocations
+// (see alloc_tracker.h).
+
+struct ProfileEvent {
+    const char* name;  // Must be a string literal (stored by pointer)
+    int64_t start;     // Nanoseconds since the profiler started
+    int64_t end;
+    uint32_t depth;    // Nesting level, 0 for top-level phases
+};
+
+struct ProfileFrame {
+    static const int MAX_EVENTS = 256;
+
+    int64_t start;
+    int64_t end;
+    int eventCount;
+    int droppedEvents; // Scopes that didn't fit in events
+    ProfileEvent events[MAX_EVENTS];
+};
+
+class Profiler {
+public:
+    static const int MAX_FRAMES = 240;
+
+    static void SetEnabled(bool enable);
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static void BeginFrame();
+    static void EndFrame();
+
+    // Used by ProfileScope; returns -1 when the scope isn't recorded
+    static int BeginScope(const char* name);
+    static void EndScope(int eventIndex);
+
+    // Completed frames, age 0 being the most recent
+    static int GetFrameCount();
+    static const ProfileFrame& GetFrame(int age);
+
+    // Writes every buffered frame as Chrome trace-event JSON
+    static bool ExportChromeTrace(const char* path);
+
+    static int64_t Now();
+
+private:
+    static inline std::atomic<bool> enabled{ false };
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : eventIndex(Profiler::IsEnabled() ? Profiler::BeginScope(name) : -1) {}
+    ~ProfileScope() {
+        if (eventIndex >= 0) Profiler::EndScope(eventIndex);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int eventIndex;
+};
+
+#ifdef ASTEROIDS_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name); ALLOC_SCOPE(name)
+#else
+#define PROFILE_SCOPE(name) ALLOC_SCOPE(name)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,144 @@
+#include "projectiles.h"
+#include "profiler.h"
+#include <algorithm>
+
+// One contiguous run of bullets. Plain arithmetic and selects, so the compiler
+// vectorizes it; returns how many are still live.
+static size_t IntegrateProjectiles(float* x, float* y, const float* speedX, const float* speedY,
+                                   float* remaining, size_t count, float deltaTime,
+                                   float worldWidth, float worldHeight) {
+    const float frames = deltaTime * 60.0f;
+    size_t live = 0;
+    for (size_t i = 0; i < count; ++i) {
+        x[i] += speedX[i] * frames;
+        y[i] += speedY[i] * frames;
+        const bool inside = (x[i] >= 0.0f) & (x[i] <= worldWidth) & (y[i] >= 0.0f) & (y[i] <= worldHeight);
+        remaining[i] = inside ? remaining[i] - deltaTime : 0.0f;
+        live += remaining[i] > 0.0f;
+    }
+    return live;
+}
+
+ProjectileStore::ProjectileStore() : head(0), count(0), live(0), mask(0) {}
+
+void ProjectileStore::SetCapacity(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+
+    x.assign(size, 0.0f);
+    y.assign(size, 0.0f);
+    previousX.assign(size, 0.0f);
+    previousY.assign(size, 0.0f);
+    speedX.assign(size, 0.0f);
+    speedY.assign(size, 0.0f);
+    remaining.assign(size, 0.0f);
+    mask = size - 1;
+    Clear();
+}
+
+bool ProjectileStore::Fire(float fireX, float fireY, float fireSpeedX, float fireSpeedY, float lifetime) {
+    if (count == x.size()) return false;
+
+    const size_t slot = Slot(count);
+    x[slot] = fireX;
+    y[slot] = fireY;
+    previousX[slot] = fireX;
+    previousY[slot] = fireY;
+    speedX[slot] = fireSpeedX;
+    speedY[slot] = fireSpeedY;
+    remaining[slot] = lifetime;
+    count++;
+    live++;
+    return true;
+}
+
+void ProjectileStore::Update(float deltaTime, float worldWidth, float worldHeight) {
+    PROFILE_SCOPE("projectile_update");
+
+    const size_t first = FirstRunLength();
+    live = IntegrateProjectiles(x.data() + head, y.data() + head, speedX.data() + head, speedY.data() + head,
+                                remaining.data() + head, first, deltaTime, worldWidth, worldHeight);
+    live += IntegrateProjectiles(x.data(), y.data(), speedX.data(), speedY.data(), remaining.data(),
+                                 count - first, deltaTime, worldWidth, worldHeight);
+
+    // Spent bullets in the middle wait until they reach the head
+    while (count > 0 && remaining[head] <= 0.0f) {
+        head = (head + 1) & mask;
+        count--;
+    }
+}
+
+void ProjectileStore::SavePreviousPositions() {
+    const size_t first = FirstRunLength();
+    std::copy(x.begin() + head, x.begin() + head + first, previousX.begin() + head);
+    std::copy(y.begin() + head, y.begin() + head + first, previousY.begin() + head);
+    std::copy(x.begin(), x.begin() + (count - first), previousX.begin());
+    std::copy(y.begin(), y.begin() + (count - first), previousY.begin());
+}
+
+void ProjectileStore::Spend(size_t slot) {
+    if (remaining[slot] > 0.0f) live--;
+    remaining[slot] = 0.0f;
+}
+
+void ProjectileStore::Clear() {
+    head = 0;
+    count = 0;
+    live = 0;
+}
+
+size_t ProjectileStore::Count() const {
+    return count;
+}
+
+size_t ProjectileStore::LiveCount() const {
+    return live;
+}
+
+size_t ProjectileStore::Capacity() const {
+    return x.size();
+}
+
+bool ProjectileStore::IsLive(size_t slot) const {
+    return remaining[slot] > 0.0f;
+}
+
+Vector2 ProjectileStore::GetPosition(size_t slot) const {
+    return { x[slot], y[slot] };
+}
+
+Vector2 ProjectileStore::GetPreviousPosition(size_t slot) const {
+    return { previousX[slot], previousY[slot] };
+}
+
+size_t ProjectileStore::FirstRunLength() const {
+    return std::min(count, x.size() - head);
+}
+
+void ProjectileStore::SaveState(Snapshot& snapshot) const {
+    const uint64_t entries = count;
+    snapshot.Write(entries);
+    snapshot.Write(static_cast<uint64_t>(live));
+    const size_t first = FirstRunLength();
+    for (const std::vector<float>* column : { &x, &y, &previousX, &previousY, &speedX, &speedY, &remaining }) {
+        snapshot.WriteArray(column->data() + head, first);
+        snapshot.WriteArray(column->data(), count - first);
+    }
+}
+
+void ProjectileStore::LoadState(SnapshotReader& reader) {
+    uint64_t entries = 0;
+    uint64_t liveEntries = 0;
+    reader.Read(entries);
+    reader.Read(liveEntries);
+    head = 0;
+    count = static_cast<size_t>(entries);
+    live = static_cast<size_t>(liveEntries);
+    for (std::vector<float>* column : { &x, &y, &previousX, &previousY, &speedX, &speedY, &remaining }) {
+        reader.ReadArray(column->data(), count);
+    }
+}
+
+size_t ProjectileStore::GetStateCapacity() const {
+    return 2 * sizeof(uint64_t) + x.size() * 7 * sizeof(float);
+}
@@ -0,0 +1,73 @@
+#ifndef PROJECTILES_H
+#define PROJECTILES_H
+
+#include "core_types.h"
+#include "snapshot.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct ProjectileDrawState;
+
+// Every bullet in flight, in a fixed-capacity ring of structure-of-arrays
+// columns. Bullets are fired at the tail and, all living equally long, run
+// out from the head, so firing and expiry are O(1) and never allocate. A
+// bullet that hits something is marked spent where it is and reclaimed once
+// the head reaches it.
+//
+// Bullets are addressed by ring slot; Slot(i) is the i-th oldest, spent ones
+// included, for i below Count().
+class ProjectileStore {
+public:
+    static constexpr float RADIUS = 3.0f; // Every bullet is the same size
+
+    ProjectileStore();
+
+    // Rounded up to a power of two. Clears the store.
+    void SetCapacity(size_t capacity);
+
+    // Speeds are pixels per 60 Hz frame. Returns false when the ring is full.
+    bool Fire(float x, float y, float speedX, float speedY, float lifetime);
+    // Moves every bullet in one pass, spends the ones that left the world or
+    // ran out of time and reclaims spent bullets from the head
+    void Update(float deltaTime, float worldWidth, float worldHeight);
+    void SavePreviousPositions();
+    void Spend(size_t slot);
+    void Clear();
+    // Copies the live bullets for the renderer. Implemented in
+    // render_state.cpp
+    void CaptureDrawState(ProjectileDrawState& out) const;
+
+    size_t Slot(size_t order) const { return (head + order) & mask; }
+    // Ring entries in use, spent bullets included
+    size_t Count() const;
+    size_t LiveCount() const;
+    size_t Capacity() const;
+    bool IsLive(size_t slot) const;
+    Vector2 GetPosition(size_t slot) const;
+    Vector2 GetPreviousPosition(size_t slot) const;
+
+    // The entries in use, oldest first; a restored store starts at slot 0
+    void SaveState(Snapshot& snapshot) const;
+    void LoadState(SnapshotReader& reader);
+    // Bytes SaveState writes with the ring full
+    size_t GetStateCapacity() const;
+
+private:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> previousX; // Position at the previous step
+    std::vector<float> previousY;
+    std::vector<float> speedX;
+    std::vector<float> speedY;
+    std::vector<float> remaining; // Seconds left; zero or less once spent
+    size_t head;                  // Oldest entry
+    size_t count;
+    size_t live;
+    size_t mask;                  // Capacity - 1
+
+    // The entries in use as at most two contiguous runs of the ring
+    size_t FirstRunLength() const;
+};
+
+#endif // PROJECTILES_H
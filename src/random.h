@@ -0,0 +1,47 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Small seeded generator (PCG32) for everything that affects gameplay. Unlike
+// the std distributions its output is fully specified, so a seed and an input
+// log replay the same game on any compiler and standard library.
+class Random {
+public:
+    explicit Random(uint64_t seed = 1) { Seed(seed); }
+
+    void Seed(uint64_t seed) {
+        state = 0;
+        NextU32();
+        state += seed;
+        NextU32();
+    }
+
+    uint32_t NextU32() {
+        uint64_t oldState = state;
+        state = oldState * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t shifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+        uint32_t rotation = static_cast<uint32_t>(oldState >> 59u);
+        return (shifted >> rotation) | (shifted << ((32u - rotation) & 31u));
+    }
+
+    // Uniform in [0, range), range > 0
+    uint32_t NextIndex(uint32_t range) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(NextU32()) * range) >> 32);
+    }
+
+    // Uniform in [min, max)
+    float NextFloat(float min, float max) {
+        float unit = static_cast<float>(NextU32() >> 8) * (1.0f / 16777216.0f);
+        return min + unit * (max - min);
+    }
+
+    bool NextBool() {
+        return (NextU32() >> 31) != 0;
+    }
+
+private:
+    uint64_t state;
+};
+
+#endif // RANDOM_H
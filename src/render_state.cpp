@@ -0,0 +1,72 @@
+#include "render_state.h"
+
+void EnemyDrawState::Reserve(size_t capacity) {
+    previousX.reserve(capacity);
+    previousY.reserve(capacity);
+    x.reserve(capacity);
+    y.reserve(capacity);
+    size.reserve(capacity);
+    health.reserve(capacity);
+    maxHealth.reserve(capacity);
+    color.reserve(capacity);
+}
+
+void ProjectileDrawState::Reserve(size_t capacity) {
+    previousX.reserve(capacity);
+    previousY.reserve(capacity);
+    x.reserve(capacity);
+    y.reserve(capacity);
+}
+
+void EnemyStore::CaptureDrawState(EnemyDrawState& out) const {
+    // Columns are dense, so each is one copy into the capacity already there
+    out.previousX.assign(previousX.begin(), previousX.end());
+    out.previousY.assign(previousY.begin(), previousY.end());
+    out.x.assign(x.begin(), x.end());
+    out.y.assign(y.begin(), y.end());
+    out.size.assign(size.begin(), size.end());
+    out.health.assign(health.begin(), health.end());
+    out.maxHealth.assign(maxHealth.begin(), maxHealth.end());
+    out.color.assign(color.begin(), color.end());
+}
+
+void ProjectileStore::CaptureDrawState(ProjectileDrawState& out) const {
+    out.previousX.clear();
+    out.previousY.clear();
+    out.x.clear();
+    out.y.clear();
+    for (size_t order = 0; order < count; ++order) {
+        const size_t slot = Slot(order);
+        if (remaining[slot] <= 0.0f) continue;
+        out.previousX.push_back(previousX[slot]);
+        out.previousY.push_back(previousY[slot]);
+        out.x.push_back(x[slot]);
+        out.y.push_back(y[slot]);
+    }
+}
+
+void RenderState::Capture(const Simulation& simulation, const ParticleSystem* source) {
+    state = simulation.GetState();
+    score = simulation.GetScore();
+    wave = simulation.GetScenario().currentWave;
+    maxWaves = simulation.GetScenario().maxWaves;
+    tick = simulation.GetTickCount();
+
+    if (player) {
+        *player = simulation.GetPlayer();
+    } else {
+        player.emplace(simulation.GetPlayer());
+    }
+
+    enemies.Reserve(simulation.GetEnemies().Capacity());
+    simulation.GetEnemies().CaptureDrawState(enemies);
+    projectiles.Reserve(simulation.GetProjectiles().Capacity());
+    simulation.GetProjectiles().CaptureDrawState(projectiles);
+
+    // Same budget on both sides, so this copies into the columns already there
+    if (source) {
+        particles = *source;
+    } else {
+        particles.Clear();
+    }
+}
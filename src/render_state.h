@@ -0,0 +1,69 @@
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+#include "simulation.h"
+#include "particles.h"
+#include <optional>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Enemy columns the renderer reads, the previous and current step included
+// for interpolation
+struct EnemyDrawState {
+    std::vector<float> previousX;
+    std::vector<float> previousY;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> size;
+    std::vector<int> health;
+    std::vector<int> maxHealth;
+    std::vector<Color> color;
+
+    void Reserve(size_t capacity);
+    size_t Count() const { return x.size(); }
+    // Sprites tinted by each enemy's color, or circles without a sprite, with
+    // health bars above. Implemented by the renderer (game.cpp)
+    void Draw(float alpha, const Sprite* sprite) const;
+};
+
+// Live bullets only, at the previous and current step
+struct ProjectileDrawState {
+    std::vector<float> previousX;
+    std::vector<float> previousY;
+    std::vector<float> x;
+    std::vector<float> y;
+
+    void Reserve(size_t capacity);
+    // Implemented by the renderer (game.cpp)
+    void Draw(float alpha) const;
+};
+
+// Everything a frame draws, copied out of the simulation after a step: the
+// player, enemies, bullets, particles and HUD values. The renderer only ever
+// reads one of these, so it can be drawn on another thread while the
+// simulation moves on (see SimulationThread). Capture reserves for full
+// pools, so after the first capture it doesn't allocate.
+struct RenderState {
+    GameState state = GameState::MENU;
+    int score = 0;
+    int wave = 0;
+    int maxWaves = 0;
+    uint64_t tick = 0;
+    // Profiler::Now() clock. When the last step was due, when the input it
+    // ran with was sampled, and how long it took.
+    int64_t stepTime = 0;
+    int64_t inputTime = 0;
+    int64_t stepNanoseconds = 0;
+
+    std::optional<Player> player; // Empty until the first capture
+    EnemyDrawState enemies;
+    ProjectileDrawState projectiles;
+    ParticleSystem particles;
+
+    // Copies the simulation's visible state and, when given, the particles.
+    // Leaves the timing fields to the caller.
+    void Capture(const Simulation& simulation, const ParticleSystem* source);
+};
+
+#endif // RENDER_STATE_H
@@ -0,0 +1,87 @@
+#include "rollback.h"
+#include "profiler.h"
+
+RollbackBuffer::RollbackBuffer(const Simulation& simulation, size_t depth)
+    : entries(depth > 0 ? depth : 1),
+      next(0),
+      count(0) {
+    const size_t bytes = simulation.GetSnapshotCapacity();
+    for (Entry& entry : entries) {
+        entry.snapshot.Reserve(bytes);
+    }
+}
+
+void RollbackBuffer::Step(Simulation& simulation, float deltaTime, const InputState& input) {
+    {
+        PROFILE_SCOPE("snapshot");
+        Entry& entry = entries[next];
+        simulation.SaveSnapshot(entry.snapshot);
+        entry.input = input;
+        entry.deltaTime = deltaTime;
+        entry.tick = simulation.GetTickCount();
+        next = (next + 1) % entries.size();
+        if (count < entries.size()) count++;
+    }
+    simulation.Step(deltaTime, input);
+}
+
+size_t RollbackBuffer::GetDepth() const {
+    return entries.size();
+}
+
+size_t RollbackBuffer::GetSize() const {
+    return count;
+}
+
+uint64_t RollbackBuffer::GetOldestTick() const {
+    return entries[(next + entries.size() - count) % entries.size()].tick;
+}
+
+bool RollbackBuffer::Rewind(Simulation& simulation, uint64_t tick) {
+    const size_t slot = FindEntry(tick);
+    if (slot == entries.size()) return false;
+
+    simulation.LoadSnapshot(entries[slot].snapshot);
+    // The rewound step and everything after it are gone
+    count -= (next + entries.size() - slot) % entries.size();
+    next = slot;
+    return true;
+}
+
+bool RollbackBuffer::CorrectInput(Simulation& simulation, uint64_t tick, const InputState& input) {
+    const size_t slot = FindEntry(tick);
+    if (slot == entries.size()) return false;
+
+    PROFILE_SCOPE("resimulate");
+    entries[slot].input = input;
+    const uint64_t present = simulation.GetTickCount();
+    simulation.LoadSnapshot(entries[slot].snapshot);
+
+    // These steps already emitted their particles the first time round
+    ParticleSystem* particles = simulation.GetParticleSystem();
+    simulation.SetParticleSystem(nullptr);
+
+    // Run the kept steps again, refreshing their snapshots on the way since
+    // every one after the corrected step may have changed
+    size_t current = slot;
+    for (uint64_t replayed = tick; replayed < present; ++replayed) {
+        Entry& entry = entries[current];
+        if (replayed != tick) simulation.SaveSnapshot(entry.snapshot);
+        simulation.Step(entry.deltaTime, entry.input);
+        current = (current + 1) % entries.size();
+    }
+    simulation.SetParticleSystem(particles);
+    return true;
+}
+
+void RollbackBuffer::Clear() {
+    next = 0;
+    count = 0;
+}
+
+size_t RollbackBuffer::FindEntry(uint64_t tick) const {
+    if (count == 0) return entries.size();
+    const uint64_t oldest = GetOldestTick();
+    if (tick < oldest || tick - oldest >= count) return entries.size();
+    return (next + entries.size() - count + static_cast<size_t>(tick - oldest)) % entries.size();
+}
@@ -0,0 +1,57 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "simulation.h"
+#include "snapshot.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Ring of the last `depth` steps: the world as it was before each one and the
+// input it ran with. Stepping through the buffer costs one snapshot per step;
+// in return the simulation can be rewound to any kept step and run forward
+// again, with the same or corrected input, which is what rollback netcode and
+// instant retries are built on. Steps are identified by the simulation's tick
+// count before them.
+//
+// Every snapshot is sized for a full enemy pool up front, so stepping never
+// allocates.
+class RollbackBuffer {
+public:
+    RollbackBuffer(const Simulation& simulation, size_t depth);
+
+    // Snapshots the simulation and remembers the input, then steps it
+    void Step(Simulation& simulation, float deltaTime, const InputState& input);
+
+    size_t GetDepth() const;
+    size_t GetSize() const;
+    // Oldest tick that can still be rewound to; only valid when not empty
+    uint64_t GetOldestTick() const;
+
+    // Restores the world from just before `tick` and forgets it and every
+    // later step. Fails if the tick is no longer (or not yet) kept.
+    bool Rewind(Simulation& simulation, uint64_t tick);
+    // Replaces the input `tick` ran with and resimulates from there back to
+    // the current tick. The simulation's particle system is detached while
+    // resimulating, so steps that already emitted their explosions, sparks
+    // and thrust don't emit them again; it is reattached afterwards.
+    bool CorrectInput(Simulation& simulation, uint64_t tick, const InputState& input);
+    void Clear();
+
+private:
+    struct Entry {
+        Snapshot snapshot; // World before the step
+        InputState input;
+        float deltaTime;
+        uint64_t tick;
+    };
+
+    std::vector<Entry> entries;
+    size_t next;  // Ring slot the next step goes in
+    size_t count;
+
+    // Ring slot holding `tick`, or entries.size() if it isn't kept
+    size_t FindEntry(uint64_t tick) const;
+};
+
+#endif // ROLLBACK_H
@@ -0,0 +1,56 @@
+#ifndef SCRIPTED_INPUT_H
+#define SCRIPTED_INPUT_H
+
+#include "simulation.h"
+#include <cstdint>
+
+// Stand-in player for the headless tools. Wanders in a random direction for a
+// while, pulses the attack regularly and keeps firing most of the time, pressing ENTER whenever the
+// simulation waits in a menu or end screen.
+class ScriptedInput {
+public:
+    explicit ScriptedInput(uint32_t seed) : state(seed ? seed : 1), heldButtons(0), holdTicks(0) {}
+
+    InputState Next(GameState gameState) {
+        InputState input;
+        if (gameState != GameState::PLAYING) {
+            input.buttons = INPUT_START;
+            return input;
+        }
+
+        if (holdTicks <= 0) {
+            static const uint8_t directions[] = {
+                0, INPUT_RIGHT, INPUT_LEFT, INPUT_UP, INPUT_DOWN,
+                INPUT_RIGHT | INPUT_UP, INPUT_RIGHT | INPUT_DOWN,
+                INPUT_LEFT | INPUT_UP, INPUT_LEFT | INPUT_DOWN
+            };
+            heldButtons = directions[NextRandom() % 9];
+            holdTicks = 10 + static_cast<int>(NextRandom() % 50);
+        }
+        holdTicks--;
+
+        input.buttons = heldButtons;
+        if (NextRandom() % 8 == 0) {
+            input.buttons |= INPUT_ATTACK;
+        }
+        if ((NextRandom() >> 8) % 4 != 0) {
+            input.buttons |= INPUT_FIRE;
+        }
+        return input;
+    }
+
+private:
+    uint32_t state;
+    uint8_t heldButtons;
+    int holdTicks;
+
+    uint32_t NextRandom() {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+#endif // SCRIPTED_INPUT_H
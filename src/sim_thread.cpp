@@ -0,0 +1,123 @@
+#include "sim_thread.h"
+#include "rollback.h"
+#include "particles.h"
+#include "profiler.h"
+#include <chrono>
+
+SimulationThread::SimulationThread(Simulation& simulation, RollbackBuffer* rollback, ParticleSystem* particles,
+                                   int tickRate, int maxSteps)
+    : simulation(simulation),
+      rollback(rollback),
+      particles(particles),
+      tickNanoseconds(1000000000LL / tickRate),
+      maxSteps(maxSteps),
+      running(false),
+      stepCount(0),
+      hasState(false),
+      heldButtons(0),
+      pressedButtons(0),
+      inputTime(0) {}
+
+SimulationThread::~SimulationThread() {
+    Stop();
+}
+
+void SimulationThread::SetInputFilter(std::function<InputState(const InputState&)> filter) {
+    inputFilter = std::move(filter);
+}
+
+void SimulationThread::SetBetweenSteps(std::function<void()> hook) {
+    betweenSteps = std::move(hook);
+}
+
+void SimulationThread::Start() {
+    if (thread.joinable()) return;
+    running.store(true, std::memory_order_relaxed);
+    thread = std::thread(&SimulationThread::Loop, this);
+}
+
+void SimulationThread::Stop() {
+    running.store(false, std::memory_order_relaxed);
+    if (thread.joinable()) thread.join();
+}
+
+void SimulationThread::SubmitInput(const InputState& input, int64_t sampleTime) {
+    const uint8_t presses = INPUT_ATTACK | INPUT_PAUSE | INPUT_START;
+    heldButtons.store(input.buttons & ~presses, std::memory_order_relaxed);
+    pressedButtons.fetch_or(input.buttons & presses, std::memory_order_relaxed);
+    inputTime.store(sampleTime, std::memory_order_release);
+}
+
+const RenderState* SimulationThread::FetchState() {
+    hasState = states.Fetch() || hasState;
+    return hasState ? &states.GetFront() : nullptr;
+}
+
+uint64_t SimulationThread::GetStepCount() const {
+    return stepCount.load(std::memory_order_relaxed);
+}
+
+void SimulationThread::Loop() {
+    const float tickLength = static_cast<float>(tickNanoseconds) / 1e9f;
+    int64_t nextStep = Profiler::Now();
+
+    while (running.load(std::memory_order_relaxed)) {
+        int64_t now = Profiler::Now();
+        if (now < nextStep) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(nextStep - now));
+            continue;
+        }
+
+        // Every step that came due since the last pass, up to the cap
+        int steps = 0;
+        int64_t stepTime = nextStep;
+        int64_t sampleTime = 0;
+        int64_t stepNanoseconds = 0;
+        while (now >= nextStep && steps < maxSteps) {
+            if (betweenSteps) betweenSteps();
+
+            // Held buttons as last submitted, presses once each
+            sampleTime = inputTime.load(std::memory_order_acquire);
+            InputState input;
+            input.buttons = heldButtons.load(std::memory_order_relaxed) |
+                            pressedButtons.exchange(0, std::memory_order_relaxed);
+            if (inputFilter) input = inputFilter(input);
+
+            const int64_t start = Profiler::Now();
+            if (rollback) {
+                rollback->Step(simulation, tickLength, input);
+            } else {
+                simulation.Step(tickLength, input);
+            }
+            now = Profiler::Now();
+            stepNanoseconds = now - start;
+            stepTime = nextStep;
+            nextStep += tickNanoseconds;
+            steps++;
+        }
+        stepCount.fetch_add(static_cast<uint64_t>(steps), std::memory_order_relaxed);
+
+        // After a long stall, drop the time we can't catch up on instead of
+        // spiralling further behind
+        if (steps == maxSteps && now >= nextStep) {
+            nextStep = now + tickNanoseconds;
+        }
+
+        // Particles follow the steps here; they freeze while paused and go
+        // when the game ends
+        if (particles) {
+            if (simulation.GetState() == GameState::PLAYING) {
+                particles->Update(tickLength * steps);
+            } else if (simulation.GetState() != GameState::PAUSED) {
+                particles->Clear();
+            }
+        }
+
+        RenderState& state = states.GetBack();
+        state.Capture(simulation, particles);
+        state.stepTime = stepTime;
+        state.inputTime = sampleTime;
+        state.stepNanoseconds = stepNanoseconds;
+        states.Publish();
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include "simulation.h"
+#include "render_state.h"
+#include "triple_buffer.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+class RollbackBuffer;
+class ParticleSystem;
+
+// Runs the simulation at its fixed rate on a thread of its own, so a slow
+// draw doesn't hold back the steps and a heavy step doesn't hold back the
+// frame. The render thread submits input whenever it samples it and fetches
+// the newest RenderState whenever it draws; both go through lock-free
+// mailboxes and neither side ever waits for the other.
+//
+// While running, the simulation, rollback buffer and particle system belong
+// to this thread; anything else that must touch them goes through the
+// between-steps hook.
+class SimulationThread {
+public:
+    // rollback and particles may be null. After a stall at most maxSteps
+    // steps are caught up on; the rest of the lost time is dropped.
+    SimulationThread(Simulation& simulation, RollbackBuffer* rollback, ParticleSystem* particles, int tickRate,
+                     int maxSteps = 5);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Set before Start; both are called on the simulation thread. The input
+    // filter turns the submitted input into the step's (replays, recording,
+    // scripted input); the hook runs before every step (config swaps,
+    // rewinds).
+    void SetInputFilter(std::function<InputState(const InputState&)> filter);
+    void SetBetweenSteps(std::function<void()> hook);
+
+    void Start();
+    // Joins the thread; the simulation is the caller's again afterwards
+    void Stop();
+
+    // Held buttons replace the last submission; presses are kept until a
+    // step consumes them. sampleTime is Profiler::Now() when it was read.
+    void SubmitInput(const InputState& input, int64_t sampleTime);
+    // The newest published state; null until the first one
+    const RenderState* FetchState();
+
+    uint64_t GetStepCount() const;
+
+private:
+    Simulation& simulation;
+    RollbackBuffer* rollback;
+    ParticleSystem* particles;
+    int64_t tickNanoseconds;
+    int maxSteps;
+    std::function<InputState(const InputState&)> inputFilter;
+    std::function<void()> betweenSteps;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> stepCount;
+    bool hasState; // Render thread's: a state was fetched at least once
+
+    // Input mailbox
+    std::atomic<uint8_t> heldButtons;
+    std::atomic<uint8_t> pressedButtons;
+    std::atomic<int64_t> inputTime;
+
+    TripleBuffer<RenderState> states;
+
+    void Loop();
+};
+
+#endif // SIM_THREAD_H
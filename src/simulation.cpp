@@ -0,0 +1,1321 @@
+#include "simulation.h"
+#include "enemy_kernels.h"
+#include "profiler.h"
+#include "job_system.h"
+#include "collision.h"
+#include "particles.h"
+#include <algorithm>
+#include <cmath>
+
+// Config Manager Implementation
+
+// Used until a compiled config is loaded; matches config/game.cfg
+static const char* defaultConfigText =
+    "player size=50 speed=5 health=3 color=0,121,241,255\n"
+    "archetype rock     size=50 speed=1 health=1 color=230,41,55,255 split=pebble fragments=2\n"
+    "archetype boulder  size=45 speed=2 health=2 color=190,33,55,255 split=pebble fragments=3\n"
+    "archetype crystal  size=40 speed=3 health=3 color=112,31,126,255 split=shard fragments=2\n"
+    "archetype pebble   size=25 speed=2 health=1 color=230,110,80,255\n"
+    "archetype shard    size=20 speed=3 health=1 color=170,90,200,255\n"
+    "wave archetype=rock    count=4\n"
+    "wave archetype=boulder count=4\n"
+    "wave archetype=crystal count=4\n";
+
+static EntityConfig ToEntityConfig(const ConfigEntityRecord& record, int archetype) {
+    EntityConfig config;
+    config.size = record.size;
+    config.speed = record.speed;
+    config.health = record.health;
+    config.color = { record.color[0], record.color[1], record.color[2], record.color[3] };
+    config.archetype = archetype;
+    if (record.splitArchetype != CONFIG_NO_SPLIT && record.fragmentCount > 0) {
+        config.splitArchetype = static_cast<int>(record.splitArchetype);
+        config.fragmentCount = static_cast<int>(record.fragmentCount);
+    }
+    return config;
+}
+
+ConfigManager::ConfigManager() : header(nullptr), archetypes(nullptr), waves(nullptr) {
+    LoadConfigs();
+}
+
+ConfigManager::~ConfigManager() = default;
+
+void ConfigManager::LoadConfigs() {
+    std::string error;
+    CompileConfig(defaultConfigText, defaultBlob, error);
+    Bind(defaultBlob.data());
+}
+
+bool ConfigManager::LoadFromFile(const std::string& path, std::string& error) {
+    auto file = std::make_unique<MappedFile>();
+    if (!file->Open(path)) {
+        error = "could not open " + path;
+        return false;
+    }
+    if (!ValidateConfigBlob(file->GetData(), file->GetSize(), error)) {
+        error = path + ": " + error;
+        return false;
+    }
+
+    // Records are read straight out of the mapping from here on
+    mapping = std::move(file);
+    Bind(mapping->GetData());
+    defaultBlob.clear();
+    defaultBlob.shrink_to_fit();
+    return true;
+}
+
+void ConfigManager::Bind(const uint8_t* data) {
+    header = reinterpret_cast<const ConfigBlobHeader*>(data);
+    archetypes = reinterpret_cast<const ConfigEntityRecord*>(data + sizeof(ConfigBlobHeader));
+    waves = reinterpret_cast<const ConfigWaveRecord*>(archetypes + header->archetypeCount);
+}
+
+int ConfigManager::ClampWave(int wave) const {
+    if (wave < 0 || wave >= static_cast<int>(header->waveCount)) {
+        return 0; // Default to the first wave if out of range
+    }
+    return wave;
+}
+
+EntityConfig ConfigManager::GetPlayerConfig() const {
+    return ToEntityConfig(header->player, -1);
+}
+
+EntityConfig ConfigManager::GetEnemyConfig(int wave) const {
+    return GetArchetypeConfig(static_cast<int>(waves[ClampWave(wave)].archetype));
+}
+
+EntityConfig ConfigManager::GetArchetypeConfig(int archetype) const {
+    return ToEntityConfig(archetypes[archetype], archetype);
+}
+
+int ConfigManager::GetArchetypeCount() const {
+    return static_cast<int>(header->archetypeCount);
+}
+
+int ConfigManager::GetWaveEnemyCount(int wave) const {
+    return static_cast<int>(waves[ClampWave(wave)].enemyCount);
+}
+
+int ConfigManager::GetWaveCount() const {
+    return static_cast<int>(header->waveCount);
+}
+
+Scenario ConfigManager::GetScenario() const {
+    Scenario scenario;
+    scenario.totalEnemies = 0;
+    for (uint32_t wave = 0; wave < header->waveCount; ++wave) {
+        scenario.totalEnemies += static_cast<int>(waves[wave].enemyCount);
+    }
+    scenario.currentWave = 0;
+    scenario.maxWaves = GetWaveCount();
+    scenario.enemiesPerWave = GetWaveEnemyCount(0);
+    scenario.baseEnemyHealth = GetEnemyConfig(0).health;
+    scenario.enemyHealthMultiplier = 1.5f;
+    scenario.enemyColor = GetEnemyConfig(0).color;
+    return scenario;
+}
+
+// Player class implementation
+Player::Player(const EntityConfig& config, float startX, float startY)
+    : player{ startX, startY, config.size, config.size },
+      speed(config.speed),
+      attacking(false),
+      health(config.health),
+      attackRadius(config.size * 1.5f),
+      invulnerabilityTimer(0.0f),
+      isInvulnerable(false),
+      rotation(0.0f),
+      position{ startX + config.size/2, startY + config.size/2 },
+      previousRotation(0.0f),
+      previousPosition{ startX + config.size/2, startY + config.size/2 },
+      velocity{ 0, 0 },
+      rotationSpeed(1.0f),
+      acceleration(0.2f),
+      drag(0.98f),
+      fireCooldown(0.0f),
+      thrusting(false) {}
+
+void Player::Update(const InputState& input, float deltaTime, float worldWidth, float worldHeight) {
+    PROFILE_SCOPE("player_update");
+
+    // Tuning values are per 60 Hz frame; scale them to this step's length
+    const float frames = deltaTime * 60.0f;
+
+    // Handle rotation based on direction
+    bool isMoving = false;
+
+    // Calculate target rotation based on input
+    float targetRotation = rotation;
+
+    if (input.IsMovingRight() && input.IsMovingUp()) {
+        targetRotation = 315.0f; // Up-right
+        isMoving = true;
+    } else if (input.IsMovingRight() && input.IsMovingDown()) {
+        targetRotation = 45.0f; // Down-right
+        isMoving = true;
+    } else if (input.IsMovingLeft() && input.IsMovingUp()) {
+        targetRotation = 225.0f; // Up-left
+        isMoving = true;
+    } else if (input.IsMovingLeft() && input.IsMovingDown()) {
+        targetRotation = 135.0f; // Down-left
+        isMoving = true;
+    } else if (input.IsMovingRight()) {
+        targetRotation = 0.0f; // Right
+        isMoving = true;
+    } else if (input.IsMovingLeft()) {
+        targetRotation = 180.0f; // Left
+        isMoving = true;
+    } else if (input.IsMovingUp()) {
+        targetRotation = 270.0f; // Up
+        isMoving = true;
+    } else if (input.IsMovingDown()) {
+        targetRotation = 90.0f; // Down
+        isMoving = true;
+    }
+
+    // Smoothly rotate towards target direction
+    if (isMoving) {
+        // Find the shortest path to rotate
+        float diff = targetRotation - rotation;
+        if (diff > 180.0f) diff -= 360.0f;
+        if (diff < -180.0f) diff += 360.0f;
+
+        // Apply rotation with the rotation speed, closing the same share of
+        // the gap per second at any step length
+        rotation += diff * (1.0f - std::pow(1.0f - 0.1f * rotationSpeed, frames));
+
+        // Keep rotation in 0-360 range
+        if (rotation < 0) rotation += 360.0f;
+        if (rotation >= 360.0f) rotation -= 360.0f;
+
+        // Apply acceleration in the direction of rotation
+        float radians = rotation * DEG2RAD;
+        velocity.x += cos(radians) * acceleration * frames;
+        velocity.y += sin(radians) * acceleration * frames;
+    }
+
+    thrusting = isMoving;
+
+    // Apply drag to slow down
+    const float stepDrag = std::pow(drag, frames);
+    velocity.x *= stepDrag;
+    velocity.y *= stepDrag;
+
+    // Update position
+    position.x += velocity.x * frames;
+    position.y += velocity.y * frames;
+
+    // Update rectangle position for collision detection
+    player.x = position.x - player.width/2;
+    player.y = position.y - player.height/2;
+
+    // Keep player within world bounds
+    if (position.x < player.width/2) {
+        position.x = player.width/2;
+        velocity.x = 0;
+    }
+    if (position.x > worldWidth - player.width/2) {
+        position.x = worldWidth - player.width/2;
+        velocity.x = 0;
+    }
+    if (position.y < player.height/2) {
+        position.y = player.height/2;
+        velocity.y = 0;
+    }
+    if (position.y > worldHeight - player.height/2) {
+        position.y = worldHeight - player.height/2;
+        velocity.y = 0;
+    }
+
+    // Set attacking state
+    attacking = input.IsAttacking();
+
+    // Count down the fire cooldown
+    if (fireCooldown > 0.0f) {
+        fireCooldown -= deltaTime;
+    }
+
+    // Update invulnerability timer
+    if (isInvulnerable) {
+        invulnerabilityTimer -= deltaTime;
+        if (invulnerabilityTimer <= 0) {
+            isInvulnerable = false;
+        }
+    }
+}
+
+void Player::SavePreviousState() {
+    previousPosition = position;
+    previousRotation = rotation;
+}
+
+Rectangle Player::GetRectangle() const {
+    return player;
+}
+
+Vector2 Player::GetPosition() const {
+    return position;
+}
+
+Vector2 Player::GetPreviousPosition() const {
+    return previousPosition;
+}
+
+float Player::GetAttackRadius() const {
+    return attackRadius;
+}
+
+float Player::GetRotation() const {
+    return rotation;
+}
+
+bool Player::IsReadyToFire() const {
+    return fireCooldown <= 0.0f;
+}
+
+void Player::StartFireCooldown(float seconds) {
+    // Keeps whatever part of a step ran past the last cooldown, so the fire
+    // rate doesn't depend on the step length
+    fireCooldown += seconds;
+}
+
+bool Player::IsThrusting() const {
+    return thrusting;
+}
+
+bool Player::IsAttacking() const {
+    return attacking;
+}
+
+void Player::TakeDamage() {
+    if (!isInvulnerable) {
+        health--;
+        isInvulnerable = true;
+        invulnerabilityTimer = 2.0f; // 2 seconds of invulnerability
+    }
+}
+
+int Player::GetHealth() const {
+    return health;
+}
+
+bool Player::IsAlive() const {
+    return health > 0;
+}
+
+// Enemy store implementation
+EnemyStore::EnemyStore() : freeSlot(INVALID_SLOT), usedSlots(0), maxSpeed(0.0f), stepTravel(0.0f) {}
+
+void EnemyStore::ConfigureGrid(float worldWidth, float worldHeight, float cellSize) {
+    grid.Configure(worldWidth, worldHeight, cellSize);
+}
+
+void EnemyStore::SetCapacity(size_t capacity) {
+    if (capacity <= slots.size()) return;
+
+    // Reserve everything up front so spawning never reallocates
+    x.reserve(capacity);
+    y.reserve(capacity);
+    previousX.reserve(capacity);
+    previousY.reserve(capacity);
+    speedX.reserve(capacity);
+    speedY.reserve(capacity);
+    size.reserve(capacity);
+    health.reserve(capacity);
+    maxHealth.reserve(capacity);
+    color.reserve(capacity);
+    archetype.reserve(capacity);
+    denseSlots.reserve(capacity);
+    pendingRemovals.reserve(capacity);
+    grid.Reserve(capacity);
+    sweep.Reserve(capacity);
+
+    // New slots are handed out lowest first once the free list runs dry
+    slots.resize(capacity, Slot{ INVALID_SLOT, 0 });
+}
+
+EnemyHandle EnemyStore::Spawn(const EntityConfig& config, float spawnX, float spawnY, float spawnSpeedX, float spawnSpeedY) {
+    // Recycled slots first, then ones never used
+    uint32_t slot;
+    if (freeSlot != INVALID_SLOT) {
+        slot = freeSlot;
+        freeSlot = slots[slot].dense;
+    } else if (usedSlots < slots.size()) {
+        slot = usedSlots++;
+    } else {
+        return EnemyHandle(); // Pool is full
+    }
+
+    const uint32_t dense = static_cast<uint32_t>(x.size());
+    slots[slot].dense = dense;
+    denseSlots.push_back(slot);
+
+    x.push_back(spawnX);
+    y.push_back(spawnY);
+    previousX.push_back(spawnX);
+    previousY.push_back(spawnY);
+    speedX.push_back(spawnSpeedX);
+    speedY.push_back(spawnSpeedY);
+    size.push_back(config.size);
+    health.push_back(config.health);
+    maxHealth.push_back(config.health);
+    color.push_back(config.color);
+    archetype.push_back(config.archetype);
+    maxSpeed = std::max(maxSpeed, std::max(std::fabs(speedX.back()), std::fabs(speedY.back())));
+    grid.Insert(dense, { spawnX, spawnY, config.size, config.size });
+
+    return { slot, slots[slot].generation };
+}
+
+bool EnemyStore::Despawn(EnemyHandle handle) {
+    const size_t index = IndexOf(handle);
+    if (index == INVALID_INDEX) {
+        return false;
+    }
+
+    // Fill the hole with the last enemy so the arrays stay dense
+    const size_t last = x.size() - 1;
+    grid.Remove(static_cast<uint32_t>(index));
+    if (index != last) {
+        MoveDense(last, index);
+    }
+    PopDense();
+
+    // Retire the slot; bumping the generation invalidates old handles
+    Slot& slot = slots[handle.slot];
+    slot.generation++;
+    slot.dense = freeSlot;
+    freeSlot = handle.slot;
+    return true;
+}
+
+void EnemyStore::Update(float deltaTime, float worldWidth, float worldHeight, JobSystem* jobs) {
+    PROFILE_SCOPE("enemy_update");
+
+    const size_t count = x.size();
+    stepTravel = maxSpeed * deltaTime * 60.0f;
+    if (!jobs || jobs->GetThreadCount() == 1) {
+        IntegrateEnemies(x.data(), y.data(), speedX.data(), speedY.data(), size.data(),
+                         count, deltaTime, worldWidth, worldHeight);
+
+        // Refile bodies that crossed a grid cell
+        for (size_t i = 0; i < count; ++i) {
+            grid.Move(static_cast<uint32_t>(i), { x[i], y[i], size[i], size[i] });
+        }
+        return;
+    }
+
+    // Each chunk integrates its enemies and updates their bounds, noting the
+    // ones that changed cell. Cell lists are shared, so relinking happens
+    // afterwards on this thread, in index order like the serial loop.
+    const size_t grainSize = 8192;
+    const size_t chunkCount = JobSystem::GetChunkCount(count, grainSize);
+    if (crossedCells.size() < chunkCount) {
+        // A chunk can't list more bodies than it has, so these never grow again
+        crossedCells.resize(chunkCount);
+        for (std::vector<uint32_t>& crossed : crossedCells) crossed.reserve(grainSize);
+    }
+    jobs->ParallelFor(count, grainSize, [this, deltaTime, worldWidth, worldHeight, grainSize](size_t begin, size_t end) {
+        IntegrateEnemies(x.data() + begin, y.data() + begin, speedX.data() + begin, speedY.data() + begin,
+                         size.data() + begin, end - begin, deltaTime, worldWidth, worldHeight);
+
+        std::vector<uint32_t>& crossed = crossedCells[begin / grainSize];
+        crossed.clear();
+        for (size_t i = begin; i < end; ++i) {
+            if (grid.SetBounds(static_cast<uint32_t>(i), { x[i], y[i], size[i], size[i] })) {
+                crossed.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    });
+
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        for (uint32_t id : crossedCells[chunk]) {
+            grid.Refile(id);
+        }
+    }
+}
+
+void EnemyStore::ResolveCollisions(float worldWidth, float worldHeight, FrameArena& arena) {
+    PROFILE_SCOPE("asteroid_collisions");
+
+    // Refresh the sweep list from last step's order, dropping despawned
+    // enemies, then add the ones spawned since
+    const size_t count = x.size();
+    FrameVector<uint8_t> listed(count, 0, ArenaAllocator<uint8_t>(arena));
+    sweep.Refresh([this, count, &listed](SweepBody& body) {
+        const uint32_t dense = slots[body.key].dense;
+        if (dense >= count || denseSlots[dense] != body.key) return false;
+        body = SweepBody{ x[dense], x[dense] + size[dense], y[dense], y[dense] + size[dense], body.key, dense };
+        listed[dense] = 1;
+        return true;
+    });
+    for (uint32_t i = 0; i < count; ++i) {
+        if (listed[i]) continue;
+        sweep.Add({ x[i], x[i] + size[i], y[i], y[i] + size[i], denseSlots[i], i });
+    }
+    sweep.Sort();
+
+    FrameVector<SweepPair> contacts{ ArenaAllocator<SweepPair>(arena) };
+    contacts.reserve(count / 4 + 16);
+    sweep.FindPairs(contacts);
+
+    for (const SweepPair& pair : contacts) {
+        if (!ResolveContact(pair.first, pair.second, worldWidth, worldHeight)) continue;
+
+        // Keep the grid and the swept-query bounds in step with the push and
+        // the new speeds
+        for (uint32_t i : { pair.first, pair.second }) {
+            grid.Move(i, { x[i], y[i], size[i], size[i] });
+            maxSpeed = std::max(maxSpeed, std::max(std::fabs(speedX[i]), std::fabs(speedY[i])));
+            stepTravel = std::max(stepTravel, std::max(std::fabs(x[i] - previousX[i]), std::fabs(y[i] - previousY[i])));
+        }
+    }
+}
+
+bool EnemyStore::ResolveContact(uint32_t a, uint32_t b, float worldWidth, float worldHeight) {
+    const float radiusA = size[a] * 0.5f;
+    const float radiusB = size[b] * 0.5f;
+    const float dx = (x[b] + radiusB) - (x[a] + radiusA);
+    const float dy = (y[b] + radiusB) - (y[a] + radiusA);
+    const float reach = radiusA + radiusB;
+    const float distanceSquared = dx * dx + dy * dy;
+    if (distanceSquared >= reach * reach) return false;
+
+    // Contact normal from a to b; concentric circles split along x
+    const float distance = std::sqrt(distanceSquared);
+    const float normalX = distance > 0.0f ? dx / distance : 1.0f;
+    const float normalY = distance > 0.0f ? dy / distance : 0.0f;
+
+    // Mass goes with area, so big rocks shove small ones aside
+    const float inverseMassA = 1.0f / (size[a] * size[a]);
+    const float inverseMassB = 1.0f / (size[b] * size[b]);
+    const float inverseMassSum = inverseMassA + inverseMassB;
+
+    // Separate the circles, each moving in inverse proportion to its mass
+    const float push = (reach - distance) / inverseMassSum;
+    x[a] = std::min(std::max(x[a] - normalX * push * inverseMassA, 0.0f), worldWidth - size[a]);
+    y[a] = std::min(std::max(y[a] - normalY * push * inverseMassA, 0.0f), worldHeight - size[a]);
+    x[b] = std::min(std::max(x[b] + normalX * push * inverseMassB, 0.0f), worldWidth - size[b]);
+    y[b] = std::min(std::max(y[b] + normalY * push * inverseMassB, 0.0f), worldHeight - size[b]);
+
+    // Bounce only if still closing; a perfectly elastic impulse along the
+    // normal conserves both momentum and kinetic energy
+    const float closing = (speedX[b] - speedX[a]) * normalX + (speedY[b] - speedY[a]) * normalY;
+    if (closing < 0.0f) {
+        const float impulse = -2.0f * closing / inverseMassSum;
+        speedX[a] -= impulse * inverseMassA * normalX;
+        speedY[a] -= impulse * inverseMassA * normalY;
+        speedX[b] += impulse * inverseMassB * normalX;
+        speedY[b] += impulse * inverseMassB * normalY;
+    }
+    return true;
+}
+
+void EnemyStore::SavePreviousPositions() {
+    PROFILE_SCOPE("save_previous_positions");
+
+    previousX = x;
+    previousY = y;
+}
+
+void EnemyStore::OnHit(size_t index, int damage) {
+    const bool wasAlive = health[index] > 0;
+    health[index] -= damage;
+    if (wasAlive && health[index] <= 0) {
+        // Queued rather than removed so indices stay valid for the rest of the pass
+        pendingRemovals.push_back(GetHandle(index));
+    }
+}
+
+const std::vector<EnemyHandle>& EnemyStore::GetPendingRemovals() const {
+    return pendingRemovals;
+}
+
+void EnemyStore::RemoveDead() {
+    // Only the enemies that died since the last call are touched
+    for (const EnemyHandle& handle : pendingRemovals) {
+        Despawn(handle);
+    }
+    pendingRemovals.clear();
+}
+
+void EnemyStore::Clear() {
+    // Retire every live slot so outstanding handles go stale
+    for (size_t i = x.size(); i-- > 0;) {
+        Despawn(GetHandle(i));
+    }
+    pendingRemovals.clear();
+    grid.Clear();
+    sweep.Clear();
+    maxSpeed = 0.0f;
+    stepTravel = 0.0f;
+}
+
+void EnemyStore::MoveDense(size_t from, size_t to) {
+    x[to] = x[from];
+    y[to] = y[from];
+    previousX[to] = previousX[from];
+    previousY[to] = previousY[from];
+    speedX[to] = speedX[from];
+    speedY[to] = speedY[from];
+    size[to] = size[from];
+    health[to] = health[from];
+    maxHealth[to] = maxHealth[from];
+    color[to] = color[from];
+    archetype[to] = archetype[from];
+    denseSlots[to] = denseSlots[from];
+    slots[denseSlots[to]].dense = static_cast<uint32_t>(to);
+    grid.Relocate(static_cast<uint32_t>(from), static_cast<uint32_t>(to));
+}
+
+void EnemyStore::PopDense() {
+    x.pop_back();
+    y.pop_back();
+    previousX.pop_back();
+    previousY.pop_back();
+    speedX.pop_back();
+    speedY.pop_back();
+    size.pop_back();
+    health.pop_back();
+    maxHealth.pop_back();
+    color.pop_back();
+    archetype.pop_back();
+    denseSlots.pop_back();
+    grid.Truncate(static_cast<uint32_t>(x.size()));
+}
+
+bool EnemyStore::IsAlive(EnemyHandle handle) const {
+    return IndexOf(handle) != INVALID_INDEX;
+}
+
+size_t EnemyStore::IndexOf(EnemyHandle handle) const {
+    if (handle.slot >= slots.size()) return INVALID_INDEX;
+    const Slot& slot = slots[handle.slot];
+    if (slot.generation != handle.generation || slot.dense >= x.size() ||
+        denseSlots[slot.dense] != handle.slot) {
+        return INVALID_INDEX;
+    }
+    return slot.dense;
+}
+
+EnemyHandle EnemyStore::GetHandle(size_t index) const {
+    const uint32_t slot = denseSlots[index];
+    return { slot, slots[slot].generation };
+}
+
+size_t EnemyStore::Capacity() const {
+    return slots.size();
+}
+
+size_t EnemyStore::Count() const {
+    return x.size();
+}
+
+bool EnemyStore::Empty() const {
+    return x.empty();
+}
+
+Rectangle EnemyStore::GetRectangle(size_t index) const {
+    return { x[index], y[index], size[index], size[index] };
+}
+
+int EnemyStore::GetHealth(size_t index) const {
+    return health[index];
+}
+
+int EnemyStore::GetPoints(size_t index) const {
+    return maxHealth[index] * 100;
+}
+
+Color EnemyStore::GetColor(size_t index) const {
+    return color[index];
+}
+
+int EnemyStore::GetArchetype(size_t index) const {
+    return archetype[index];
+}
+
+Vector2 EnemyStore::GetSpeed(size_t index) const {
+    return { speedX[index], speedY[index] };
+}
+
+Vector2 EnemyStore::GetPreviousPosition(size_t index) const {
+    return { previousX[index], previousY[index] };
+}
+
+float EnemyStore::GetStepTravel() const {
+    return stepTravel;
+}
+
+size_t EnemyStore::SweepAgainstCircle(const uint32_t* candidates, size_t count, const SweptCircle& circle,
+                                      uint8_t* hits) const {
+    return SweepEnemiesAgainstCircle(x.data(), y.data(), previousX.data(), previousY.data(), size.data(),
+                                     candidates, count, circle, hits);
+}
+
+const SpatialGrid& EnemyStore::GetGrid() const {
+    return grid;
+}
+
+void EnemyStore::SaveState(Snapshot& snapshot) const {
+    snapshot.WriteVector(x);
+    snapshot.WriteVector(y);
+    snapshot.WriteVector(previousX);
+    snapshot.WriteVector(previousY);
+    snapshot.WriteVector(speedX);
+    snapshot.WriteVector(speedY);
+    snapshot.WriteVector(size);
+    snapshot.WriteVector(health);
+    snapshot.WriteVector(maxHealth);
+    snapshot.WriteVector(color);
+    snapshot.WriteVector(archetype);
+    snapshot.WriteVector(denseSlots);
+    // Slots past usedSlots hold nothing yet, so only the used prefix is kept
+    snapshot.Write(usedSlots);
+    snapshot.WriteArray(slots.data(), usedSlots);
+    snapshot.Write(freeSlot);
+    snapshot.Write(maxSpeed);
+    snapshot.Write(stepTravel);
+    snapshot.WriteVector(pendingRemovals);
+    grid.SaveState(snapshot);
+    sweep.SaveState(snapshot);
+}
+
+void EnemyStore::LoadState(SnapshotReader& reader) {
+    reader.ReadVector(x);
+    reader.ReadVector(y);
+    reader.ReadVector(previousX);
+    reader.ReadVector(previousY);
+    reader.ReadVector(speedX);
+    reader.ReadVector(speedY);
+    reader.ReadVector(size);
+    reader.ReadVector(health);
+    reader.ReadVector(maxHealth);
+    reader.ReadVector(color);
+    reader.ReadVector(archetype);
+    reader.ReadVector(denseSlots);
+    reader.Read(usedSlots);
+    if (usedSlots > slots.size()) slots.resize(usedSlots, Slot{ INVALID_SLOT, 0 });
+    reader.ReadArray(slots.data(), usedSlots);
+    reader.Read(freeSlot);
+    reader.Read(maxSpeed);
+    reader.Read(stepTravel);
+    reader.ReadVector(pendingRemovals);
+    grid.LoadState(reader);
+    sweep.LoadState(reader);
+}
+
+size_t EnemyStore::GetStateCapacity() const {
+    const size_t capacity = slots.size();
+    const size_t perEnemy = 8 * sizeof(float) + 2 * sizeof(int) + sizeof(Color) + sizeof(int32_t) +
+                            sizeof(uint32_t) + sizeof(Slot) + sizeof(EnemyHandle);
+    // One length prefix per WriteVector in SaveState: the twelve columns and
+    // pendingRemovals. Keep in step when SaveState gains or loses a vector.
+    const size_t savedVectors = 13;
+    return capacity * perEnemy + savedVectors * sizeof(uint64_t) + sizeof(usedSlots) + sizeof(freeSlot) +
+           2 * sizeof(float) + grid.GetStateCapacity(capacity) + sweep.GetStateCapacity(capacity);
+}
+
+// Simulation class implementation
+Simulation::Simulation(float worldWidth, float worldHeight, size_t enemyCapacity, uint64_t seed)
+    : worldWidth(worldWidth),
+      worldHeight(worldHeight),
+      configManager(std::make_unique<ConfigManager>()),
+      gameState(GameState::MENU),
+      score(0),
+      gameTimer(0.0f),
+      tickCount(0),
+      seed(seed),
+      random(seed),
+      jobs(nullptr),
+      particles(nullptr),
+      tickArena("tick", 256 * 1024) {
+    // Cells a bit larger than the biggest asteroid keep most queries to a few cells
+    enemies.ConfigureGrid(worldWidth, worldHeight, 64.0f);
+    enemies.SetCapacity(enemyCapacity);
+    pendingFragments.reserve(enemyCapacity);
+    projectiles.SetCapacity(8192);
+    ReserveSpawnCells();
+    Reset();
+}
+
+void Simulation::Reset() {
+    // Get scenario configuration
+    scenario = configManager->GetScenario();
+
+    // Initialize player at center of the world, reusing the existing one so
+    // restarts don't allocate
+    const EntityConfig& playerConfig = configManager->GetPlayerConfig();
+    const Player fresh(
+        playerConfig,
+        worldWidth / 2.0f - playerConfig.size / 2,
+        worldHeight / 2.0f - playerConfig.size / 2
+    );
+    if (player) {
+        *player = fresh;
+    } else {
+        player = std::make_unique<Player>(fresh);
+    }
+    score = 0; // Reset score
+
+    // Clear enemies to start fresh
+    enemies.Clear();
+    pendingFragments.clear();
+    projectiles.Clear();
+}
+
+void Simulation::Step(float deltaTime, const InputState& input) {
+    PROFILE_SCOPE("simulation_step");
+
+    // Keep the last step's poses so renderers can interpolate between steps
+    SavePreviousState();
+
+    switch (gameState) {
+        case GameState::MENU:
+            HandleMenuState(input);
+            break;
+
+        case GameState::PLAYING:
+            HandlePlayingState(deltaTime, input);
+            break;
+
+        case GameState::PAUSED:
+            HandlePausedState(input);
+            break;
+
+        case GameState::GAME_OVER:
+            HandleGameOverState(input);
+            break;
+
+        case GameState::VICTORY:
+            HandleVictoryState(input);
+            break;
+    }
+
+    tickCount++;
+    tickArena.Reset();
+}
+
+void Simulation::SetJobSystem(JobSystem* jobSystem) {
+    jobs = jobSystem;
+}
+
+void Simulation::SetParticleSystem(ParticleSystem* particleSystem) {
+    particles = particleSystem;
+}
+
+ParticleSystem* Simulation::GetParticleSystem() const {
+    return particles;
+}
+
+void Simulation::SetConfig(std::unique_ptr<ConfigManager> config) {
+    configManager = std::move(config);
+    ReserveSpawnCells();
+
+    // Keep the game's progress, take the new wave table
+    const Scenario fresh = configManager->GetScenario();
+    scenario.totalEnemies = fresh.totalEnemies;
+    scenario.maxWaves = fresh.maxWaves;
+    if (scenario.currentWave >= scenario.maxWaves) {
+        scenario.currentWave = scenario.maxWaves - 1;
+    }
+    scenario.enemiesPerWave = configManager->GetWaveEnemyCount(scenario.currentWave);
+}
+
+void Simulation::SaveSnapshot(Snapshot& snapshot) const {
+    snapshot.Clear();
+    snapshot.Write(worldWidth);
+    snapshot.Write(worldHeight);
+    snapshot.Write(scenario);
+    snapshot.Write(*player);
+    snapshot.Write(gameState);
+    snapshot.Write(score);
+    snapshot.Write(gameTimer);
+    snapshot.Write(tickCount);
+    snapshot.Write(random);
+    enemies.SaveState(snapshot);
+    projectiles.SaveState(snapshot);
+    spawnPlacer.SaveState(snapshot);
+}
+
+void Simulation::LoadSnapshot(const Snapshot& snapshot) {
+    SnapshotReader reader(snapshot);
+    reader.Read(worldWidth);
+    reader.Read(worldHeight);
+    reader.Read(scenario);
+    reader.Read(*player);
+    reader.Read(gameState);
+    reader.Read(score);
+    reader.Read(gameTimer);
+    reader.Read(tickCount);
+    reader.Read(random);
+    enemies.LoadState(reader);
+    projectiles.LoadState(reader);
+    spawnPlacer.LoadState(reader);
+}
+
+size_t Simulation::GetSnapshotCapacity() const {
+    return 2 * sizeof(float) + sizeof(Scenario) + sizeof(Player) + sizeof(GameState) + sizeof(int) +
+           sizeof(float) + sizeof(uint64_t) + sizeof(Random) + enemies.GetStateCapacity() +
+           projectiles.GetStateCapacity() + spawnPlacer.GetStateCapacity();
+}
+
+GameState Simulation::GetState() const {
+    return gameState;
+}
+
+const Player& Simulation::GetPlayer() const {
+    return *player;
+}
+
+const EnemyStore& Simulation::GetEnemies() const {
+    return enemies;
+}
+
+const ProjectileStore& Simulation::GetProjectiles() const {
+    return projectiles;
+}
+
+void Simulation::SavePreviousState() {
+    player->SavePreviousState();
+    enemies.SavePreviousPositions();
+    projectiles.SavePreviousPositions();
+}
+
+EnemyStore& Simulation::GetEnemies() {
+    return enemies;
+}
+
+ProjectileStore& Simulation::GetProjectiles() {
+    return projectiles;
+}
+
+FrameArena& Simulation::GetTickArena() {
+    return tickArena;
+}
+
+const Scenario& Simulation::GetScenario() const {
+    return scenario;
+}
+
+int Simulation::GetScore() const {
+    return score;
+}
+
+float Simulation::GetGameTimer() const {
+    return gameTimer;
+}
+
+uint64_t Simulation::GetTickCount() const {
+    return tickCount;
+}
+
+float Simulation::GetWorldWidth() const {
+    return worldWidth;
+}
+
+uint64_t Simulation::GetSeed() const {
+    return seed;
+}
+
+float Simulation::GetWorldHeight() const {
+    return worldHeight;
+}
+
+void Simulation::ReserveSpawnCells() {
+    float smallest = configManager->GetEnemyConfig(0).size;
+    for (int archetype = 0; archetype < configManager->GetArchetypeCount(); ++archetype) {
+        smallest = std::min(smallest, configManager->GetArchetypeConfig(archetype).size);
+    }
+    spawnPlacer.SetArea(worldWidth - 50, worldHeight - 50);
+    spawnPlacer.Reserve(smallest);
+}
+
+void Simulation::SpawnEnemies(int count) {
+    PROFILE_SCOPE("spawn_enemies");
+
+    if (count <= 0) return;
+    const EntityConfig& enemyConfig = configManager->GetEnemyConfig(scenario.currentWave);
+
+    // Keep asteroids from spawning on top of the player or each other
+    const Rectangle playerRect = player->GetRectangle();
+    const float minDistance = 150.0f;
+    FrameVector<Vector2> spawnPositions{ ArenaAllocator<Vector2>(tickArena) };
+    spawnPositions.reserve(static_cast<size_t>(count));
+    spawnPlacer.SetArea(worldWidth - 50, worldHeight - 50);
+    spawnPlacer.Place(random, static_cast<size_t>(count), enemyConfig.size, { playerRect.x, playerRect.y },
+                      minDistance, spawnPositions);
+
+    for (const Vector2& position : spawnPositions) {
+        float speedX = random.NextFloat(0.0f, 2.0f);
+        float speedY = random.NextFloat(0.0f, 2.0f);
+
+        // 50% chance to reverse direction
+        if (random.NextBool()) speedX = -speedX;
+        if (random.NextBool()) speedY = -speedY;
+
+        // Add base speed to random speed
+        enemies.Spawn(enemyConfig, position.x, position.y, speedX + enemyConfig.speed, speedY + enemyConfig.speed);
+    }
+}
+
+void Simulation::CheckAttackCollisions() {
+    PROFILE_SCOPE("attack_collisions");
+
+    if (!player->IsAttacking()) {
+        return;
+    }
+
+    // The attack reaches a circle around the ship, which moves over the step;
+    // asteroids are swept against it so hits can't be stepped over. Hits are
+    // applied in grid order, however the query was split.
+    const SweptCircle attack = GetPlayerSweep(player->GetAttackRadius());
+    QueryScratch scratch(tickArena);
+    QueryEnemies(GetSweptQueryArea(attack), scratch);
+    KeepSweptHits(attack, scratch);
+    for (uint32_t index : scratch.candidates) {
+        HandleEnemyHit(index);
+    }
+}
+
+void Simulation::CheckProjectileCollisions() {
+    PROFILE_SCOPE("projectile_collisions");
+
+    // Each bullet sweeps its step through the same grid query and narrow
+    // phase as the attack, oldest bullet first, and stops at the first
+    // asteroid it reaches. Asteroids already destroyed this step are passed
+    // through.
+    QueryScratch scratch(tickArena);
+    scratch.candidates.reserve(256);
+    scratch.hits.reserve(256);
+    for (size_t order = 0; order < projectiles.Count(); ++order) {
+        const size_t slot = projectiles.Slot(order);
+        if (!projectiles.IsLive(slot)) continue;
+
+        const Vector2 start = projectiles.GetPreviousPosition(slot);
+        const Vector2 end = projectiles.GetPosition(slot);
+        const SweptCircle bullet = { start.x, start.y, end.x - start.x, end.y - start.y, ProjectileStore::RADIUS };
+        QueryEnemies(GetSweptQueryArea(bullet), scratch);
+        KeepSweptHits(bullet, scratch);
+
+        size_t target = EnemyStore::INVALID_INDEX;
+        float earliest = 2.0f;
+        for (uint32_t index : scratch.candidates) {
+            if (enemies.GetHealth(index) <= 0) continue;
+            const Rectangle bounds = enemies.GetRectangle(index);
+            const Vector2 previous = enemies.GetPreviousPosition(index);
+            const float radius = bounds.width * 0.5f;
+            float toi = 0.0f;
+            if (SweepCircles({ start.x, start.y }, { bullet.moveX, bullet.moveY }, bullet.radius,
+                             { previous.x + radius, previous.y + radius },
+                             { bounds.x - previous.x, bounds.y - previous.y }, radius, toi) &&
+                toi < earliest) {
+                earliest = toi;
+                target = index;
+            }
+        }
+        if (target != EnemyStore::INVALID_INDEX) {
+            HandleEnemyHit(target);
+            projectiles.Spend(slot);
+        }
+    }
+}
+
+void Simulation::FireProjectiles(const InputState& input) {
+    const float cooldown = 0.1f;
+    const float lifetime = 1.0f;
+    const float speed = 12.0f; // Pixels per 60 Hz frame
+
+    if (!input.IsFiring() || !player->IsReadyToFire()) return;
+
+    // From the nose of the ship, along its heading
+    const float radians = player->GetRotation() * DEG2RAD;
+    const float directionX = std::cos(radians);
+    const float directionY = std::sin(radians);
+    const Vector2 position = player->GetPosition();
+    const float nose = player->GetRectangle().width * 0.8f;
+    projectiles.Fire(position.x + directionX * nose, position.y + directionY * nose,
+                     directionX * speed, directionY * speed, lifetime);
+    player->StartFireCooldown(cooldown);
+}
+
+void Simulation::CheckPlayerEnemyCollisions() {
+    PROFILE_SCOPE("player_collisions");
+
+    if (!player->IsAlive()) return;
+
+    // Ship and asteroids are both swept as circles, so a fast asteroid can't
+    // pass through the ship between steps
+    const SweptCircle ship = GetPlayerSweep(player->GetRectangle().width / 2);
+    QueryScratch scratch(tickArena);
+    QueryEnemies(GetSweptQueryArea(ship), scratch);
+    KeepSweptHits(ship, scratch);
+    for (size_t i = 0; i < scratch.candidates.size(); ++i) {
+        player->TakeDamage();
+
+        // Check if player died
+        if (!player->IsAlive()) {
+            GameOver();
+            break;
+        }
+    }
+}
+
+SweptCircle Simulation::GetPlayerSweep(float radius) const {
+    const Vector2 start = player->GetPreviousPosition();
+    const Vector2 end = player->GetPosition();
+    return { start.x, start.y, end.x - start.x, end.y - start.y, radius };
+}
+
+Rectangle Simulation::GetSweptQueryArea(const SweptCircle& circle) const {
+    const float reach = circle.radius + enemies.GetStepTravel();
+    const float minX = std::min(circle.x, circle.x + circle.moveX) - reach;
+    const float minY = std::min(circle.y, circle.y + circle.moveY) - reach;
+    const float maxX = std::max(circle.x, circle.x + circle.moveX) + reach;
+    const float maxY = std::max(circle.y, circle.y + circle.moveY) + reach;
+    return { minX, minY, maxX - minX, maxY - minY };
+}
+
+void Simulation::KeepSweptHits(const SweptCircle& circle, QueryScratch& scratch) {
+    FrameVector<uint32_t>& candidates = scratch.candidates;
+    scratch.hits.resize(candidates.size());
+    if (enemies.SweepAgainstCircle(candidates.data(), candidates.size(), circle, scratch.hits.data()) ==
+        candidates.size()) {
+        return;
+    }
+    size_t kept = 0;
+    for (size_t k = 0; k < candidates.size(); ++k) {
+        if (scratch.hits[k]) candidates[kept++] = candidates[k];
+    }
+    candidates.resize(kept);
+}
+
+void Simulation::QueryEnemies(const Rectangle& area, QueryScratch& scratch) {
+    const SpatialGrid& grid = enemies.GetGrid();
+    const int rowCount = grid.QueryRowCount(area);
+
+    // Small queries (the usual case) cost less than waking the workers
+    const int bandRows = 4;
+    if (!jobs || jobs->GetThreadCount() == 1 || rowCount < bandRows * 4) {
+        grid.QueryRect(area, scratch.candidates);
+        return;
+    }
+
+    // Each band of rows fills its own list; joining them in band order gives
+    // the ids in exactly the order a single query would
+    const size_t bandCount = JobSystem::GetChunkCount(static_cast<size_t>(rowCount), bandRows);
+    if (bandResults.size() < bandCount) bandResults.resize(bandCount);
+    jobs->ParallelFor(static_cast<size_t>(rowCount), bandRows, [this, &grid, &area, bandRows](size_t begin, size_t end) {
+        grid.QueryRectRows(area, static_cast<int>(begin), static_cast<int>(end), bandResults[begin / bandRows]);
+    });
+
+    size_t total = 0;
+    for (size_t band = 0; band < bandCount; ++band) total += bandResults[band].size();
+    scratch.candidates.clear();
+    scratch.candidates.reserve(total);
+    for (size_t band = 0; band < bandCount; ++band) {
+        scratch.candidates.insert(scratch.candidates.end(), bandResults[band].begin(), bandResults[band].end());
+    }
+}
+
+void Simulation::HandleEnemyHit(size_t index) {
+    enemies.OnHit(index);
+    const bool destroyed = enemies.GetHealth(index) <= 0;
+
+    if (destroyed) {
+        score += enemies.GetPoints(index) * (scenario.currentWave + 1);
+    }
+
+    if (particles) {
+        // Sparks for a hit, a burst of debris in the rock's color for a kill,
+        // both drifting with the rock
+        const Rectangle bounds = enemies.GetRectangle(index);
+        const Vector2 speed = enemies.GetSpeed(index);
+        ParticleBurst burst;
+        burst.position = { bounds.x + bounds.width * 0.5f, bounds.y + bounds.height * 0.5f };
+        burst.velocity = { speed.x * 60.0f, speed.y * 60.0f };
+        burst.direction = 0.0f;
+        burst.spread = 2.0f * PI;
+        if (destroyed) {
+            burst.count = static_cast<int>(bounds.width * 0.6f);
+            burst.speed = 180.0f;
+            burst.lifetime = 0.7f;
+            burst.size = 4.0f;
+            burst.color = enemies.GetColor(index);
+        } else {
+            burst.count = 6;
+            burst.speed = 240.0f;
+            burst.lifetime = 0.25f;
+            burst.size = 2.0f;
+            burst.color = Color{ 255, 203, 0, 255 };
+        }
+        particles->Emit(burst);
+    }
+}
+
+void Simulation::EmitThrust() {
+    // Exhaust out of the back of the ship, opposite its heading
+    const float radians = player->GetRotation() * DEG2RAD;
+    const Vector2 position = player->GetPosition();
+    const float tail = player->GetRectangle().width * 0.4f;
+    ParticleBurst burst;
+    burst.position = { position.x - std::cos(radians) * tail, position.y - std::sin(radians) * tail };
+    burst.velocity = { 0.0f, 0.0f };
+    burst.direction = radians + PI;
+    burst.spread = 0.6f;
+    burst.count = 2;
+    burst.speed = 150.0f;
+    burst.lifetime = 0.35f;
+    burst.size = 3.0f;
+    burst.color = Color{ 255, 161, 0, 255 };
+    particles->Emit(burst);
+}
+
+void Simulation::RemoveDeadEnemies() {
+    PROFILE_SCOPE("remove_dead_enemies");
+
+    // Note where each splitting asteroid died before it is despawned. Only
+    // archetypes still in the current config split, and a full queue drops
+    // the rest rather than growing.
+    const int archetypeCount = configManager->GetArchetypeCount();
+    for (const EnemyHandle& handle : enemies.GetPendingRemovals()) {
+        const size_t index = enemies.IndexOf(handle);
+        const int archetype = index != EnemyStore::INVALID_INDEX ? enemies.GetArchetype(index) : -1;
+        if (archetype < 0 || archetype >= archetypeCount) continue;
+
+        const EntityConfig config = configManager->GetArchetypeConfig(archetype);
+        if (config.fragmentCount == 0 || pendingFragments.size() == pendingFragments.capacity()) continue;
+
+        const Rectangle bounds = enemies.GetRectangle(index);
+        const Vector2 speed = enemies.GetSpeed(index);
+        pendingFragments.push_back({ bounds.x + bounds.width * 0.5f, bounds.y + bounds.height * 0.5f,
+                                     speed.x, speed.y, config.splitArchetype, config.fragmentCount });
+    }
+
+    enemies.RemoveDead();
+}
+
+void Simulation::SpawnFragments() {
+    PROFILE_SCOPE("spawn_fragments");
+
+    // Fragments fan out evenly from the parent's center at a random turn,
+    // each kicked outwards at its archetype's speed on top of the parent's
+    // velocity. They may start overlapping; asteroid collisions push them
+    // apart on the next step. Once the pool is full the rest are dropped.
+    for (const FragmentBatch& batch : pendingFragments) {
+        const EntityConfig config = configManager->GetArchetypeConfig(batch.archetype);
+        const float half = config.size * 0.5f;
+        const float turn = random.NextFloat(0.0f, 2.0f * PI);
+        for (int i = 0; i < batch.count; ++i) {
+            const float angle = turn + 2.0f * PI * i / batch.count;
+            const float directionX = std::cos(angle);
+            const float directionY = std::sin(angle);
+            const float x = std::min(std::max(batch.centerX + directionX * half - half, 0.0f), worldWidth - config.size);
+            const float y = std::min(std::max(batch.centerY + directionY * half - half, 0.0f), worldHeight - config.size);
+            enemies.Spawn(config, x, y, batch.speedX + directionX * config.speed, batch.speedY + directionY * config.speed);
+        }
+    }
+    pendingFragments.clear();
+}
+
+void Simulation::CheckWaveCleared() {
+    if (!enemies.Empty()) return;
+
+    if (scenario.currentWave < scenario.maxWaves - 1) {
+        StartNewWave();
+    } else {
+        Victory();
+    }
+}
+
+void Simulation::StartNewWave() {
+    scenario.currentWave++;
+    scenario.enemiesPerWave = configManager->GetWaveEnemyCount(scenario.currentWave);
+    SpawnEnemies(scenario.enemiesPerWave);
+}
+
+void Simulation::GameOver() {
+    gameState = GameState::GAME_OVER;
+}
+
+void Simulation::Victory() {
+    gameState = GameState::VICTORY;
+}
+
+void Simulation::HandleMenuState(const InputState& input) {
+    if (input.IsStartPressed()) {
+        // Reset game state
+        Reset();
+
+        // Start first wave
+        SpawnEnemies(
+            scenario.enemiesPerWave
+        );
+
+        gameState = GameState::PLAYING;
+    }
+}
+
+void Simulation::HandlePlayingState(float deltaTime, const InputState& input) {
+    // Update game time
+    gameTimer += deltaTime;
+
+    // Update player
+    player->Update(input, deltaTime, worldWidth, worldHeight);
+    if (particles && player->IsThrusting()) {
+        EmitThrust();
+    }
+
+    // Fire and move bullets
+    FireProjectiles(input);
+    projectiles.Update(deltaTime, worldWidth, worldHeight);
+
+    // Update enemies
+    enemies.Update(deltaTime, worldWidth, worldHeight, jobs);
+    enemies.ResolveCollisions(worldWidth, worldHeight, tickArena);
+
+    // Check for pause
+    if (input.IsPausePressed()) {
+        gameState = GameState::PAUSED;
+        return;
+    }
+
+    // Check collisions. Kills from the attack and bullets are removed before
+    // the ship is tested, so a destroyed asteroid can't hurt it.
+    CheckAttackCollisions();
+    CheckProjectileCollisions();
+    RemoveDeadEnemies();
+    CheckPlayerEnemyCollisions();
+
+    // The step's kills split at the end, in one batch, before checking
+    // whether the wave is over
+    SpawnFragments();
+    if (gameState == GameState::PLAYING) {
+        CheckWaveCleared();
+    }
+}
+
+void Simulation::HandlePausedState(const InputState& input) {
+    if (input.IsPausePressed()) {
+        gameState = GameState::PLAYING;
+    }
+}
+
+void Simulation::HandleGameOverState(const InputState& input) {
+    if (input.IsStartPressed()) {
+        // Reset game and go to menu
+        Reset();
+        gameState = GameState::MENU;
+    }
+}
+
+void Simulation::HandleVictoryState(const InputState& input) {
+    if (input.IsStartPressed()) {
+        // Reset game and go to menu
+        Reset();
+        gameState = GameState::MENU;
+    }
+}
@@ -0,0 +1,417 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "core_types.h"
+#include "spatial_grid.h"
+#include "sweep_and_prune.h"
+#include "projectiles.h"
+#include "random.h"
+#include "spawn_placer.h"
+#include "config_format.h"
+#include "mapped_file.h"
+#include "snapshot.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+class JobSystem;
+class ParticleSystem;
+struct Sprite;
+struct EnemyDrawState;
+struct SweptCircle;
+
+// Game states
+enum class GameState {
+    MENU,
+    PLAYING,
+    PAUSED,
+    GAME_OVER,
+    VICTORY
+};
+
+// Configuration struct for game entities
+struct EntityConfig {
+    float size;
+    float speed;
+    int health;
+    Color color;
+    int archetype = -1;      // Index in the archetype table, -1 for none
+    int splitArchetype = -1; // Archetype the fragments use, -1 if it doesn't split
+    int fragmentCount = 0;   // Fragments spawned when destroyed
+};
+
+// Game scenario definition
+struct Scenario {
+    int totalEnemies;
+    int currentWave;
+    int maxWaves;
+    int enemiesPerWave;
+    int baseEnemyHealth;
+    float enemyHealthMultiplier;
+    Color enemyColor;
+};
+
+// Buttons the simulation reacts to, one bit each
+enum InputButton : uint8_t {
+    INPUT_RIGHT  = 1 << 0,
+    INPUT_LEFT   = 1 << 1,
+    INPUT_UP     = 1 << 2,
+    INPUT_DOWN   = 1 << 3,
+    INPUT_ATTACK = 1 << 4, // Pressed this step
+    INPUT_PAUSE  = 1 << 5, // Pressed this step
+    INPUT_START  = 1 << 6, // Pressed this step
+    INPUT_FIRE   = 1 << 7  // Held
+};
+
+// Input for a single simulation step. InputHandler fills it from the keyboard,
+// headless tools script it directly.
+struct InputState {
+    uint8_t buttons = 0;
+
+    bool IsMovingRight() const { return (buttons & INPUT_RIGHT) != 0; }
+    bool IsMovingLeft() const { return (buttons & INPUT_LEFT) != 0; }
+    bool IsMovingUp() const { return (buttons & INPUT_UP) != 0; }
+    bool IsMovingDown() const { return (buttons & INPUT_DOWN) != 0; }
+    bool IsAttacking() const { return (buttons & INPUT_ATTACK) != 0; }
+    bool IsPausePressed() const { return (buttons & INPUT_PAUSE) != 0; }
+    bool IsStartPressed() const { return (buttons & INPUT_START) != 0; }
+    bool IsFiring() const { return (buttons & INPUT_FIRE) != 0; }
+};
+
+// Game configuration: the player, the enemy archetypes and the wave table.
+// Reads a compiled config (see config_format.h) in place from a memory
+// mapping; until one is loaded it uses the built-in defaults.
+class ConfigManager {
+public:
+    ConfigManager();
+    ~ConfigManager();
+
+    // Maps a compiled config file. On failure keeps the current config and
+    // sets error.
+    bool LoadFromFile(const std::string& path, std::string& error);
+
+    EntityConfig GetPlayerConfig() const;
+    EntityConfig GetEnemyConfig(int wave) const;
+    EntityConfig GetArchetypeConfig(int archetype) const;
+    int GetArchetypeCount() const;
+    int GetWaveEnemyCount(int wave) const;
+    int GetWaveCount() const;
+    Scenario GetScenario() const;
+
+private:
+    std::unique_ptr<MappedFile> mapping;
+    std::vector<uint8_t> defaultBlob; // Compiled built-in config
+    const ConfigBlobHeader* header;
+    const ConfigEntityRecord* archetypes;
+    const ConfigWaveRecord* waves;
+
+    void LoadConfigs();
+    void Bind(const uint8_t* data);
+    int ClampWave(int wave) const;
+};
+
+class Player {
+public:
+    Player(const EntityConfig& config, float startX, float startY);
+    void Update(const InputState& input, float deltaTime, float worldWidth, float worldHeight);
+    void SavePreviousState();
+    // Draws between the previous and current step; alpha 0 is the previous one.
+    // Uses the sprite when given, a triangle otherwise. Implemented by the
+    // renderer (game.cpp)
+    void Draw(float alpha = 1.0f, const Sprite* sprite = nullptr) const;
+    Rectangle GetRectangle() const;
+    // Center now and at the previous step, for swept collision tests
+    Vector2 GetPosition() const;
+    Vector2 GetPreviousPosition() const;
+    float GetAttackRadius() const;
+    // Heading in degrees, 0 facing right
+    float GetRotation() const;
+    // The gun cools down between shots
+    bool IsReadyToFire() const;
+    // Accelerated this step
+    bool IsThrusting() const;
+    void StartFireCooldown(float seconds);
+    bool IsAttacking() const;
+    void TakeDamage();
+    int GetHealth() const;
+    bool IsAlive() const;
+
+private:
+    Rectangle player;
+    float speed;
+    bool attacking;
+    int health;
+    float attackRadius;
+    float invulnerabilityTimer;
+    bool isInvulnerable;
+    float rotation;      // Rotation angle in degrees
+    Vector2 position;    // Center position of the player
+    float previousRotation;   // State at the previous step, for interpolation
+    Vector2 previousPosition;
+    Vector2 velocity;    // Current velocity vector
+    float rotationSpeed; // How quickly the ship rotates
+    float acceleration;  // Movement acceleration
+    float drag;          // Deceleration factor
+    float fireCooldown;  // Seconds until the gun can fire again
+    bool thrusting;
+};
+
+// Stable reference to a pooled enemy. Slots are reused, so the generation tells
+// the enemy a handle was issued for apart from whatever took its slot later.
+struct EnemyHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return slot != UINT32_MAX; }
+};
+
+// Structure-of-arrays storage for every live enemy. Enemy i is index i across
+// all arrays, so the update, collision and draw passes stream through flat
+// memory instead of chasing one heap allocation per asteroid. A spatial grid
+// indexed by the same ids is kept in step with every move, spawn and removal.
+//
+// The store is a fixed-capacity pool: handles map through a slot table with a
+// free list to the dense index, and despawning swaps the last enemy into the
+// hole. Spawn and despawn are O(1) and never allocate once SetCapacity ran.
+// Dense indices are only valid until the next despawn; hold handles instead.
+class EnemyStore {
+public:
+    static constexpr size_t INVALID_INDEX = SIZE_MAX;
+
+    EnemyStore();
+
+    void ConfigureGrid(float worldWidth, float worldHeight, float cellSize);
+    void SetCapacity(size_t capacity);
+
+    // Returns an invalid handle when the pool is full. The speed is taken as
+    // given; the config's base speed is the caller's to add.
+    EnemyHandle Spawn(const EntityConfig& config, float x, float y, float speedX, float speedY);
+    // Returns false for stale handles
+    bool Despawn(EnemyHandle handle);
+    // With a job system, integration and grid bookkeeping are split into
+    // chunks across its threads; the result is the same either way
+    void Update(float deltaTime, float worldWidth, float worldHeight, JobSystem* jobs = nullptr);
+    // Elastic collisions between asteroids, after Update. A sort-and-sweep
+    // broadphase finds touching pairs; each is pushed apart and, if closing,
+    // bounced with an impulse weighted by mass (proportional to area). The
+    // pair list and other scratch come from arena.
+    void ResolveCollisions(float worldWidth, float worldHeight, FrameArena& arena);
+    void SavePreviousPositions();
+    // Copies what the renderer draws. Implemented in render_state.cpp
+    void CaptureDrawState(EnemyDrawState& out) const;
+    // Enemies killed by a hit are queued and despawned by RemoveDead
+    void OnHit(size_t index, int damage = 1);
+    const std::vector<EnemyHandle>& GetPendingRemovals() const;
+    void RemoveDead();
+    void Clear();
+
+    bool IsAlive(EnemyHandle handle) const;
+    // Dense index of a live enemy, or INVALID_INDEX for stale handles
+    size_t IndexOf(EnemyHandle handle) const;
+    EnemyHandle GetHandle(size_t index) const;
+    size_t Capacity() const;
+    size_t Count() const;
+    bool Empty() const;
+    Rectangle GetRectangle(size_t index) const;
+    int GetHealth(size_t index) const;
+    int GetPoints(size_t index) const;
+    Color GetColor(size_t index) const;
+    // Archetype the enemy was spawned from, -1 for none
+    int GetArchetype(size_t index) const;
+    // Pixels per 60 Hz frame
+    Vector2 GetSpeed(size_t index) const;
+    // Top-left corner at the previous step
+    Vector2 GetPreviousPosition(size_t index) const;
+    // Upper bound on how far any enemy moved along either axis in the last
+    // Update, for growing broadphase queries to cover the whole step
+    float GetStepTravel() const;
+    // Narrow phase for broadphase candidates against a moving circle; see
+    // SweepEnemiesAgainstCircle. Returns the number of hits.
+    size_t SweepAgainstCircle(const uint32_t* candidates, size_t count, const SweptCircle& circle,
+                              uint8_t* hits) const;
+    const SpatialGrid& GetGrid() const;
+
+    // Everything but the scratch buffers, slot table and grid lists included,
+    // so query order survives a restore. Handles issued after a snapshot may
+    // alias other enemies once it is restored; look them up again.
+    void SaveState(Snapshot& snapshot) const;
+    void LoadState(SnapshotReader& reader);
+    // Bytes SaveState writes with the pool full
+    size_t GetStateCapacity() const;
+
+private:
+    std::vector<float> x;       // Top-left corner
+    std::vector<float> y;
+    std::vector<float> previousX; // Position at the previous step, for interpolation
+    std::vector<float> previousY;
+    std::vector<float> speedX;
+    std::vector<float> speedY;
+    std::vector<float> size;    // Width and height
+    std::vector<int> health;
+    std::vector<int> maxHealth; // Health at spawn, also sets the points value
+    std::vector<Color> color;
+    std::vector<int32_t> archetype;
+    std::vector<uint32_t> denseSlots; // Slot owning each dense index
+
+    struct Slot {
+        uint32_t dense;      // Dense index while live, next free slot otherwise
+        uint32_t generation; // Bumped on every despawn
+    };
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+    std::vector<Slot> slots;
+    uint32_t freeSlot;
+    uint32_t usedSlots; // Slots ever handed out; the rest have never been used
+    float maxSpeed;     // Largest speed component spawned since the last Clear
+    float stepTravel;   // maxSpeed over the last Update's step
+    std::vector<EnemyHandle> pendingRemovals;
+    SpatialGrid grid;
+    std::vector<std::vector<uint32_t>> crossedCells; // Per chunk: bodies that changed grid cell
+    SweepAndPrune sweep;               // Keyed by slot, so the order survives despawns
+
+    // Returns false when the circles don't touch
+    bool ResolveContact(uint32_t a, uint32_t b, float worldWidth, float worldHeight);
+
+    void MoveDense(size_t from, size_t to);
+    void PopDense();
+};
+
+// Headless world simulation. Owns everything that affects gameplay and advances
+// it one Step at a time; it never touches the window, keyboard or clock, so it
+// can run without raylib at whatever rate the caller drives it.
+class Simulation {
+public:
+    // Same seed and same inputs from construction on give the same game
+    Simulation(float worldWidth, float worldHeight, size_t enemyCapacity = 4096, uint64_t seed = 1);
+
+    void Reset();
+    void Step(float deltaTime, const InputState& input);
+    // Optional; spreads the enemy update and large collision queries over the
+    // job system's threads. Results match the single-threaded step exactly.
+    void SetJobSystem(JobSystem* jobs);
+    // Optional; receives hit sparks, explosions and the ship's thrust trail.
+    // Purely cosmetic: particles aren't part of the world or its snapshots.
+    void SetParticleSystem(ParticleSystem* particles);
+    ParticleSystem* GetParticleSystem() const;
+    // Swaps in a new configuration between steps. The wave in progress keeps
+    // going; the next spawns and waves use the new tables, and the player
+    // picks up its new settings when the next game starts.
+    void SetConfig(std::unique_ptr<ConfigManager> config);
+
+    // Captures or restores the whole world (player, enemies, scenario, score,
+    // timers, state and the random generator) so a restored simulation steps
+    // exactly as the captured one did. The config, seed and job system aren't
+    // part of it; a snapshot is restored under whatever config is current.
+    void SaveSnapshot(Snapshot& snapshot) const;
+    void LoadSnapshot(const Snapshot& snapshot);
+    // Bytes a snapshot takes with the enemy pool full, for preallocating
+    size_t GetSnapshotCapacity() const;
+
+    GameState GetState() const;
+    const Player& GetPlayer() const;
+    const EnemyStore& GetEnemies() const;
+    const ProjectileStore& GetProjectiles() const;
+    const Scenario& GetScenario() const;
+    int GetScore() const;
+    float GetGameTimer() const;
+    uint64_t GetTickCount() const;
+    uint64_t GetSeed() const;
+    float GetWorldWidth() const;
+    float GetWorldHeight() const;
+
+    // Individual phases of a playing step, public so benchmarks and tools can
+    // drive and time them one at a time. SavePreviousState starts every step;
+    // the collision passes sweep each body from there to where it is now.
+    EnemyStore& GetEnemies();
+    ProjectileStore& GetProjectiles();
+    // Scratch memory of the phases below. Step resets it when it finishes;
+    // callers running phases on their own reset it between them.
+    FrameArena& GetTickArena();
+    void SavePreviousState();
+    void SpawnEnemies(int count);
+    void CheckAttackCollisions();
+    void CheckPlayerEnemyCollisions();
+    void CheckProjectileCollisions();
+    // Despawns the enemies killed since the last call, queueing fragments for
+    // the ones that split; SpawnFragments adds the queued fragments in one
+    // batch at the end of the step
+    void RemoveDeadEnemies();
+    void SpawnFragments();
+    void HandlePlayingState(float deltaTime, const InputState& input);
+
+private:
+    float worldWidth;
+    float worldHeight;
+    Scenario scenario;
+    std::unique_ptr<ConfigManager> configManager;
+    std::unique_ptr<Player> player;
+    EnemyStore enemies;
+    ProjectileStore projectiles;
+    GameState gameState;
+    int score;
+    float gameTimer;
+    uint64_t tickCount;
+    uint64_t seed;
+    Random random;     // All gameplay randomness, seeded once at construction
+    JobSystem* jobs;   // Not owned, may be null
+    ParticleSystem* particles; // Not owned, may be null
+    SpawnPlacer spawnPlacer;
+    // Scratch for the step: query candidates, hit lists, contact pairs and
+    // spawn positions. Reset at the end of every Step.
+    FrameArena tickArena;
+    // Per row band of a split query. Filled on worker threads, so these stay
+    // ordinary vectors that keep their capacity from step to step.
+    std::vector<std::vector<uint32_t>> bandResults;
+
+    // One collision pass's broadphase candidates and narrow phase results,
+    // reused for every query in the pass
+    struct QueryScratch {
+        explicit QueryScratch(FrameArena& arena) : candidates(ArenaAllocator<uint32_t>(arena)), hits(ArenaAllocator<uint8_t>(arena)) {}
+        FrameVector<uint32_t> candidates;
+        FrameVector<uint8_t> hits;
+    };
+
+    // A destroyed asteroid waiting for its fragments. The queue is reserved
+    // to the enemy capacity and always empty between steps, so it is neither
+    // allocated during play nor part of snapshots.
+    struct FragmentBatch {
+        float centerX;
+        float centerY;
+        float speedX;
+        float speedY;
+        int archetype; // Of the fragments
+        int count;
+    };
+    std::vector<FragmentBatch> pendingFragments;
+
+    // Candidates for the area, in grid order
+    void QueryEnemies(const Rectangle& area, QueryScratch& scratch);
+    // Sizes the spawn cell table for the config's smallest archetype
+    void ReserveSpawnCells();
+    // Area a circle covers over the step, grown by how far enemies moved, so
+    // the grid finds every enemy a sweep could reach
+    Rectangle GetSweptQueryArea(const SweptCircle& circle) const;
+    // Narrows the candidates down to the enemies the circle's sweep hits,
+    // keeping their order
+    void KeepSweptHits(const SweptCircle& circle, QueryScratch& scratch);
+    // The ship's center over the step, with the given reach
+    SweptCircle GetPlayerSweep(float radius) const;
+
+    void HandleEnemyHit(size_t index);
+    void EmitThrust();
+    // Shoots along the ship's heading while fire is held, one bullet per
+    // cooldown
+    void FireProjectiles(const InputState& input);
+    // Next wave or victory once the field is clear
+    void CheckWaveCleared();
+    void StartNewWave();
+    void GameOver();
+    void Victory();
+    void HandleMenuState(const InputState& input);
+    void HandlePausedState(const InputState& input);
+    void HandleGameOverState(const InputState& input);
+    void HandleVictoryState(const InputState& input);
+};
+
+#endif // SIMULATION_H
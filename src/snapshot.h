@@ -0,0 +1,100 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Flat byte image of simulation state: trivially copyable values and arrays
+// memcpy'd back to back, with no pointers, so taking one is a handful of
+// bulk copies. The buffer keeps its size between uses, so once it has held
+// the largest state it never allocates again. Reserved memory is left
+// uninitialised, so the OS only commits the pages a snapshot actually fills.
+class Snapshot {
+public:
+    Snapshot() : capacity(0), used(0) {}
+
+    void Reserve(size_t bytes) {
+        if (bytes > capacity) Grow(bytes);
+    }
+    void Clear() { used = 0; }
+    size_t Size() const { return used; }
+    const uint8_t* Data() const { return buffer.get(); }
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain data only");
+        Append(&value, sizeof(T));
+    }
+
+    // Elements only; the reader must know the count
+    template <typename T>
+    void WriteArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain data only");
+        Append(values, count * sizeof(T));
+    }
+
+    // Element count followed by the elements
+    template <typename T>
+    void WriteVector(const std::vector<T>& values) {
+        const uint64_t count = values.size();
+        Append(&count, sizeof(count));
+        WriteArray(values.data(), values.size());
+    }
+
+private:
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t capacity;
+    size_t used;
+
+    void Grow(size_t bytes) {
+        std::unique_ptr<uint8_t[]> larger(new uint8_t[bytes]);
+        if (used > 0) std::memcpy(larger.get(), buffer.get(), used);
+        buffer = std::move(larger);
+        capacity = bytes;
+    }
+
+    void Append(const void* data, size_t length) {
+        if (used + length > capacity) Grow(std::max(used + length, capacity * 2));
+        if (length > 0) std::memcpy(buffer.get() + used, data, length);
+        used += length;
+    }
+};
+
+// Reads a snapshot back in the order it was written
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const Snapshot& snapshot) : data(snapshot.Data()), offset(0) {}
+
+    template <typename T>
+    void Read(T& value) {
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    template <typename T>
+    void ReadArray(T* values, size_t count) {
+        if (count > 0) std::memcpy(values, data + offset, count * sizeof(T));
+        offset += count * sizeof(T);
+    }
+
+    // Resizes the vector, which stays within its capacity when it was
+    // reserved for the largest state
+    template <typename T>
+    void ReadVector(std::vector<T>& values) {
+        uint64_t count = 0;
+        Read(count);
+        values.resize(static_cast<size_t>(count));
+        ReadArray(values.data(), values.size());
+    }
+
+private:
+    const uint8_t* data;
+    size_t offset;
+};
+
+#endif // SNAPSHOT_H
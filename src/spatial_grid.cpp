@@ -0,0 +1,260 @@
+#include "spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid()
+    : worldWidth(0.0f),
+      worldHeight(0.0f),
+      cellSize(1.0f),
+      inverseCellSize(1.0f),
+      columns(1),
+      rows(1),
+      maxHalfExtent(0.0f),
+      cellHeads(1, -1) {}
+
+void SpatialGrid::Configure(float width, float height, float size) {
+    worldWidth = width;
+    worldHeight = height;
+    cellSize = size;
+    inverseCellSize = 1.0f / size;
+    columns = std::max(1, static_cast<int>(std::ceil(width * inverseCellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(height * inverseCellSize)));
+    cellHeads.assign(static_cast<size_t>(columns) * rows, -1);
+
+    // Refile anything already inserted under the new layout
+    for (uint32_t id = 0; id < bodies.size(); ++id) {
+        if (bodies[id].cell < 0) continue;
+        bodies[id].cell = -1;
+        const Body& body = bodies[id];
+        Link(id, CellIndex((body.minX + body.maxX) * 0.5f, (body.minY + body.maxY) * 0.5f));
+    }
+}
+
+void SpatialGrid::Reserve(size_t capacity) {
+    bodies.reserve(capacity);
+}
+
+void SpatialGrid::Clear() {
+    std::fill(cellHeads.begin(), cellHeads.end(), -1);
+    bodies.clear();
+    maxHalfExtent = 0.0f;
+}
+
+void SpatialGrid::Insert(uint32_t id, const Rectangle& bounds) {
+    if (id >= bodies.size()) {
+        bodies.resize(id + 1, Body{ 0.0f, 0.0f, 0.0f, 0.0f, -1, -1, -1 });
+    }
+    Body& body = bodies[id];
+    body.minX = bounds.x;
+    body.minY = bounds.y;
+    body.maxX = bounds.x + bounds.width;
+    body.maxY = bounds.y + bounds.height;
+    maxHalfExtent = std::max(maxHalfExtent, std::max(bounds.width, bounds.height) * 0.5f);
+    Link(id, CellIndex(bounds.x + bounds.width * 0.5f, bounds.y + bounds.height * 0.5f));
+}
+
+void SpatialGrid::Move(uint32_t id, const Rectangle& bounds) {
+    Body& body = bodies[id];
+    body.minX = bounds.x;
+    body.minY = bounds.y;
+    body.maxX = bounds.x + bounds.width;
+    body.maxY = bounds.y + bounds.height;
+
+    // Only touch the lists when the body crosses into another cell
+    int32_t cell = CellIndex(bounds.x + bounds.width * 0.5f, bounds.y + bounds.height * 0.5f);
+    if (cell != body.cell) {
+        Unlink(id);
+        Link(id, cell);
+    }
+}
+
+bool SpatialGrid::SetBounds(uint32_t id, const Rectangle& bounds) {
+    Body& body = bodies[id];
+    body.minX = bounds.x;
+    body.minY = bounds.y;
+    body.maxX = bounds.x + bounds.width;
+    body.maxY = bounds.y + bounds.height;
+    return CellIndex(bounds.x + bounds.width * 0.5f, bounds.y + bounds.height * 0.5f) != body.cell;
+}
+
+void SpatialGrid::Refile(uint32_t id) {
+    const Body& body = bodies[id];
+    int32_t cell = CellIndex((body.minX + body.maxX) * 0.5f, (body.minY + body.maxY) * 0.5f);
+    Unlink(id);
+    Link(id, cell);
+}
+
+void SpatialGrid::Remove(uint32_t id) {
+    Unlink(id);
+}
+
+void SpatialGrid::Relocate(uint32_t from, uint32_t to) {
+    Body& body = bodies[to];
+    body = bodies[from];
+    if (body.prev >= 0) {
+        bodies[body.prev].next = static_cast<int32_t>(to);
+    } else if (body.cell >= 0) {
+        cellHeads[body.cell] = static_cast<int32_t>(to);
+    }
+    if (body.next >= 0) {
+        bodies[body.next].prev = static_cast<int32_t>(to);
+    }
+    bodies[from].cell = -1;
+    bodies[from].prev = -1;
+    bodies[from].next = -1;
+}
+
+void SpatialGrid::Truncate(uint32_t count) {
+    if (count < bodies.size()) {
+        bodies.resize(count);
+    }
+}
+
+template<typename Ids>
+void SpatialGrid::QueryRect(const Rectangle& area, Ids& out) const {
+    QueryRectRows(area, 0, QueryRowCount(area), out);
+}
+
+int SpatialGrid::QueryRowCount(const Rectangle& area) const {
+    int firstColumn, firstRow, lastColumn, lastRow;
+    CellRange(area.x, area.y, area.x + area.width, area.y + area.height, firstColumn, firstRow, lastColumn, lastRow);
+    return lastRow - firstRow + 1;
+}
+
+template<typename Ids>
+void SpatialGrid::QueryRectRows(const Rectangle& area, int rowBegin, int rowEnd, Ids& out) const {
+    out.clear();
+    const float areaMaxX = area.x + area.width;
+    const float areaMaxY = area.y + area.height;
+
+    int firstColumn, firstRow, lastColumn, lastRow;
+    CellRange(area.x, area.y, areaMaxX, areaMaxY, firstColumn, firstRow, lastColumn, lastRow);
+    lastRow = std::min(lastRow, firstRow + rowEnd - 1);
+    firstRow += rowBegin;
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            for (int32_t id = cellHeads[row * columns + column]; id >= 0; id = bodies[id].next) {
+                const Body& body = bodies[id];
+                if (area.x < body.maxX && areaMaxX > body.minX &&
+                    area.y < body.maxY && areaMaxY > body.minY) {
+                    out.push_back(static_cast<uint32_t>(id));
+                }
+            }
+        }
+    }
+}
+
+template<typename Ids>
+void SpatialGrid::QueryCircle(Vector2 center, float radius, Ids& out) const {
+    out.clear();
+    const float radiusSquared = radius * radius;
+
+    int firstColumn, firstRow, lastColumn, lastRow;
+    CellRange(center.x - radius, center.y - radius, center.x + radius, center.y + radius,
+              firstColumn, firstRow, lastColumn, lastRow);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            for (int32_t id = cellHeads[row * columns + column]; id >= 0; id = bodies[id].next) {
+                const Body& body = bodies[id];
+                // Distance from the circle center to the closest point of the bounds
+                float dx = std::max(body.minX - center.x, std::max(0.0f, center.x - body.maxX));
+                float dy = std::max(body.minY - center.y, std::max(0.0f, center.y - body.maxY));
+                if (dx * dx + dy * dy <= radiusSquared) {
+                    out.push_back(static_cast<uint32_t>(id));
+                }
+            }
+        }
+    }
+}
+
+template void SpatialGrid::QueryRect(const Rectangle&, std::vector<uint32_t>&) const;
+template void SpatialGrid::QueryRect(const Rectangle&, FrameVector<uint32_t>&) const;
+template void SpatialGrid::QueryRectRows(const Rectangle&, int, int, std::vector<uint32_t>&) const;
+template void SpatialGrid::QueryRectRows(const Rectangle&, int, int, FrameVector<uint32_t>&) const;
+template void SpatialGrid::QueryCircle(Vector2, float, std::vector<uint32_t>&) const;
+template void SpatialGrid::QueryCircle(Vector2, float, FrameVector<uint32_t>&) const;
+
+size_t SpatialGrid::Count() const {
+    return bodies.size();
+}
+
+int SpatialGrid::CellIndex(float centerX, float centerY) const {
+    // Bodies outside the world are filed in the nearest edge cell
+    int column = static_cast<int>(centerX * inverseCellSize);
+    int row = static_cast<int>(centerY * inverseCellSize);
+    column = std::min(std::max(column, 0), columns - 1);
+    row = std::min(std::max(row, 0), rows - 1);
+    return row * columns + column;
+}
+
+void SpatialGrid::Link(uint32_t id, int32_t cell) {
+    Body& body = bodies[id];
+    body.cell = cell;
+    body.prev = -1;
+    body.next = cellHeads[cell];
+    if (body.next >= 0) {
+        bodies[body.next].prev = static_cast<int32_t>(id);
+    }
+    cellHeads[cell] = static_cast<int32_t>(id);
+}
+
+void SpatialGrid::Unlink(uint32_t id) {
+    Body& body = bodies[id];
+    if (body.cell < 0) return;
+
+    if (body.prev >= 0) {
+        bodies[body.prev].next = body.next;
+    } else {
+        cellHeads[body.cell] = body.next;
+    }
+    if (body.next >= 0) {
+        bodies[body.next].prev = body.prev;
+    }
+    body.cell = -1;
+    body.prev = -1;
+    body.next = -1;
+}
+
+void SpatialGrid::CellRange(float minX, float minY, float maxX, float maxY,
+                            int& firstColumn, int& firstRow, int& lastColumn, int& lastRow) const {
+    // Bodies are filed by center, so pad the range by the largest half-size
+    firstColumn = static_cast<int>(std::floor((minX - maxHalfExtent) * inverseCellSize));
+    firstRow = static_cast<int>(std::floor((minY - maxHalfExtent) * inverseCellSize));
+    lastColumn = static_cast<int>(std::floor((maxX + maxHalfExtent) * inverseCellSize));
+    lastRow = static_cast<int>(std::floor((maxY + maxHalfExtent) * inverseCellSize));
+    firstColumn = std::min(std::max(firstColumn, 0), columns - 1);
+    firstRow = std::min(std::max(firstRow, 0), rows - 1);
+    lastColumn = std::min(std::max(lastColumn, 0), columns - 1);
+    lastRow = std::min(std::max(lastRow, 0), rows - 1);
+}
+
+void SpatialGrid::SaveState(Snapshot& snapshot) const {
+    snapshot.Write(worldWidth);
+    snapshot.Write(worldHeight);
+    snapshot.Write(cellSize);
+    snapshot.Write(inverseCellSize);
+    snapshot.Write(columns);
+    snapshot.Write(rows);
+    snapshot.Write(maxHalfExtent);
+    snapshot.WriteVector(cellHeads);
+    snapshot.WriteVector(bodies);
+}
+
+void SpatialGrid::LoadState(SnapshotReader& reader) {
+    reader.Read(worldWidth);
+    reader.Read(worldHeight);
+    reader.Read(cellSize);
+    reader.Read(inverseCellSize);
+    reader.Read(columns);
+    reader.Read(rows);
+    reader.Read(maxHalfExtent);
+    reader.ReadVector(cellHeads);
+    reader.ReadVector(bodies);
+}
+
+size_t SpatialGrid::GetStateCapacity(size_t bodyCount) const {
+    return 5 * sizeof(float) + 2 * sizeof(int) + 2 * sizeof(uint64_t) +
+           cellHeads.size() * sizeof(int32_t) + bodyCount * sizeof(Body);
+}
@@ -0,0 +1,90 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "core_types.h"
+#include "snapshot.h"
+#include "frame_arena.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Uniform grid broadphase over a fixed world rectangle. Each body is filed in
+// the cell containing its center, with cells kept as intrusive doubly linked
+// lists so moving, removing or renumbering a body is O(1). Bodies only change
+// lists when they cross a cell edge, so a frame's update touches few links.
+//
+// Body ids are caller-chosen dense indices (EnemyStore uses its array index).
+class SpatialGrid {
+public:
+    SpatialGrid();
+
+    void Configure(float worldWidth, float worldHeight, float cellSize);
+    void Reserve(size_t capacity);
+    void Clear();
+
+    void Insert(uint32_t id, const Rectangle& bounds);
+    void Move(uint32_t id, const Rectangle& bounds);
+    // Move split in two for parallel updates: SetBounds only writes the body's
+    // own bounds (safe to call for different ids at once) and reports whether
+    // it now belongs in another cell; Refile then relinks it, one at a time
+    bool SetBounds(uint32_t id, const Rectangle& bounds);
+    void Refile(uint32_t id);
+    void Remove(uint32_t id);
+    // Renumbers body `from` as `to` (which must be free), keeping its cell
+    void Relocate(uint32_t from, uint32_t to);
+    // Drops trailing ids >= count; they must already have been removed
+    void Truncate(uint32_t count);
+
+    // Appends ids of bodies whose bounds overlap the rectangle (same strict test
+    // as CheckCollisionRecs). `out` is cleared first. Queries fill either a
+    // std::vector or a FrameVector of uint32_t.
+    template<typename Ids>
+    void QueryRect(const Rectangle& area, Ids& out) const;
+    // Grid rows a QueryRect over the area visits. Querying the bands
+    // [0, a), [a, b), ... of them in order yields the same ids in the same
+    // order as one QueryRect, so large queries can be split across threads.
+    int QueryRowCount(const Rectangle& area) const;
+    template<typename Ids>
+    void QueryRectRows(const Rectangle& area, int rowBegin, int rowEnd, Ids& out) const;
+    // Appends ids of bodies whose bounds come within `radius` of `center`
+    template<typename Ids>
+    void QueryCircle(Vector2 center, float radius, Ids& out) const;
+
+    size_t Count() const;
+
+    // Cell lists included, so queries after a restore visit bodies in the
+    // same order as before
+    void SaveState(Snapshot& snapshot) const;
+    void LoadState(SnapshotReader& reader);
+    // Bytes SaveState writes once `bodyCount` bodies are filed
+    size_t GetStateCapacity(size_t bodyCount) const;
+
+private:
+    struct Body {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        int32_t cell; // -1 when not filed
+        int32_t prev;
+        int32_t next;
+    };
+
+    float worldWidth;
+    float worldHeight;
+    float cellSize;
+    float inverseCellSize;
+    int columns;
+    int rows;
+    float maxHalfExtent; // Largest body half-size seen, pads queries
+    std::vector<int32_t> cellHeads;
+    std::vector<Body> bodies;
+
+    int CellIndex(float centerX, float centerY) const;
+    void Link(uint32_t id, int32_t cell);
+    void Unlink(uint32_t id);
+    void CellRange(float minX, float minY, float maxX, float maxY,
+                   int& firstColumn, int& firstRow, int& lastColumn, int& lastRow) const;
+};
+
+#endif // SPATIAL_GRID_H
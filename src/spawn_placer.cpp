@@ -0,0 +1,169 @@
+#include "spawn_placer.h"
+#include <algorithm>
+#include <cmath>
+
+// Cells are this much wider than the bodies, which leaves room for jitter
+static const float cellSpacing = 1.5f;
+
+SpawnPlacer::SpawnPlacer()
+    : areaWidth(0.0f),
+      areaHeight(0.0f),
+      cellSize(0.0f),
+      columns(0),
+      rows(0) {}
+
+void SpawnPlacer::SetArea(float width, float height) {
+    if (width == areaWidth && height == areaHeight) return;
+    areaWidth = width;
+    areaHeight = height;
+    cellSize = 0.0f; // Rebuilt on the next Place
+}
+
+void SpawnPlacer::Place(Random& random, size_t count, float bodySize, Vector2 avoid, float avoidDistance,
+                        FrameVector<Vector2>& out) {
+    out.clear();
+    if (count == 0) return;
+    if (std::max(bodySize, 1.0f) * cellSpacing != cellSize) {
+        BuildCells(bodySize);
+    }
+
+    Exclusion exclusion = { avoid, avoidDistance * avoidDistance };
+    size_t clearCells = CountClearCells(exclusion);
+    if (clearCells == 0) {
+        // The zone covers the whole area; placing anywhere beats placing nothing
+        exclusion.distanceSquared = 0.0f;
+        clearCells = cells.size();
+    }
+
+    // Each pass uses every clear cell at most once; only requests larger than
+    // the clear area need more than one
+    const float jitter = cellSize - std::max(bodySize, 1.0f);
+    while (out.size() < count) {
+        const size_t wanted = std::min(count - out.size(), clearCells);
+        if (wanted * 4 >= clearCells) {
+            PlaceInOrder(random, wanted, clearCells, exclusion, jitter, out);
+        } else {
+            PlaceShuffled(random, wanted, exclusion, jitter, out);
+        }
+    }
+}
+
+void SpawnPlacer::Reserve(float bodySize) {
+    const float size = std::max(bodySize, 1.0f) * cellSpacing;
+    const size_t reserveColumns = static_cast<size_t>(std::max(1, static_cast<int>(std::ceil(areaWidth / size))));
+    const size_t reserveRows = static_cast<size_t>(std::max(1, static_cast<int>(std::ceil(areaHeight / size))));
+    cells.reserve(reserveColumns * reserveRows);
+}
+
+size_t SpawnPlacer::GetCellCount() const {
+    return cells.size();
+}
+
+void SpawnPlacer::BuildCells(float bodySize) {
+    cellSize = std::max(bodySize, 1.0f) * cellSpacing;
+    // Partial cells at the right and bottom edges still fit a body's corner;
+    // Emit clamps it into the area
+    columns = std::max(1, static_cast<int>(std::ceil(areaWidth / cellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(areaHeight / cellSize)));
+
+    cells.resize(static_cast<size_t>(columns) * rows);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        cells[i] = static_cast<uint32_t>(i);
+    }
+}
+
+void SpawnPlacer::PlaceShuffled(Random& random, size_t wanted, const Exclusion& exclusion, float jitter,
+                                FrameVector<Vector2>& out) {
+    // Partial Fisher-Yates over the cell table: each draw picks from the cells
+    // not drawn yet in this call, so no cell is used twice. The table is left
+    // shuffled, which is as good a starting order as any for the next call.
+    const size_t cellCount = cells.size();
+    const size_t target = out.size() + wanted;
+    for (size_t cursor = 0; cursor < cellCount && out.size() < target; ++cursor) {
+        const size_t pick = cursor + random.NextIndex(static_cast<uint32_t>(cellCount - cursor));
+        std::swap(cells[cursor], cells[pick]);
+        const int column = static_cast<int>(cells[cursor] % columns);
+        const int row = static_cast<int>(cells[cursor] / columns);
+        if (IsCellClear(column, row, exclusion)) {
+            Emit(random, column, row, jitter, out);
+        }
+    }
+}
+
+void SpawnPlacer::PlaceInOrder(Random& random, size_t wanted, size_t clearCells, const Exclusion& exclusion,
+                               float jitter, FrameVector<Vector2>& out) {
+    // Selection sampling: walk the clear cells in memory order and take each
+    // with probability (still wanted) / (still unvisited). Exactly `wanted`
+    // cells come out, uniformly chosen, with one draw per visited cell and
+    // no random access, which beats shuffling once a large share is used.
+    size_t remaining = clearCells;
+    for (int row = 0; row < rows && wanted > 0; ++row) {
+        for (int column = 0; column < columns && wanted > 0; ++column) {
+            if (!IsCellClear(column, row, exclusion)) continue;
+            if (random.NextIndex(static_cast<uint32_t>(remaining)) < wanted) {
+                Emit(random, column, row, jitter, out);
+                wanted--;
+            }
+            remaining--;
+        }
+    }
+}
+
+void SpawnPlacer::Emit(Random& random, int column, int row, float jitter, FrameVector<Vector2>& out) const {
+    const float cellX = static_cast<float>(column) * cellSize;
+    const float cellY = static_cast<float>(row) * cellSize;
+    out.push_back({
+        std::min(cellX + random.NextFloat(0.0f, jitter), areaWidth),
+        std::min(cellY + random.NextFloat(0.0f, jitter), areaHeight)
+    });
+}
+
+size_t SpawnPlacer::CountClearCells(const Exclusion& exclusion) const {
+    // Only cells overlapping the zone's bounding box can be blocked
+    const float radius = std::sqrt(exclusion.distanceSquared);
+    const int firstColumn = std::max(0, static_cast<int>(std::floor((exclusion.center.x - radius) / cellSize)) - 1);
+    const int lastColumn = std::min(columns - 1, static_cast<int>(std::floor((exclusion.center.x + radius) / cellSize)) + 1);
+    const int firstRow = std::max(0, static_cast<int>(std::floor((exclusion.center.y - radius) / cellSize)) - 1);
+    const int lastRow = std::min(rows - 1, static_cast<int>(std::floor((exclusion.center.y + radius) / cellSize)) + 1);
+
+    size_t blocked = 0;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            if (!IsCellClear(column, row, exclusion)) blocked++;
+        }
+    }
+    return cells.size() - blocked;
+}
+
+bool SpawnPlacer::IsCellClear(int column, int row, const Exclusion& exclusion) const {
+    // Distance from the zone center to the nearest corner position in the cell
+    const float minX = static_cast<float>(column) * cellSize;
+    const float minY = static_cast<float>(row) * cellSize;
+    const float maxX = minX + cellSize;
+    const float maxY = minY + cellSize;
+    const float dx = std::max(minX - exclusion.center.x, std::max(0.0f, exclusion.center.x - maxX));
+    const float dy = std::max(minY - exclusion.center.y, std::max(0.0f, exclusion.center.y - maxY));
+    return dx * dx + dy * dy >= exclusion.distanceSquared;
+}
+
+void SpawnPlacer::SaveState(Snapshot& snapshot) const {
+    snapshot.Write(areaWidth);
+    snapshot.Write(areaHeight);
+    snapshot.Write(cellSize);
+    snapshot.Write(columns);
+    snapshot.Write(rows);
+    snapshot.WriteVector(cells);
+}
+
+void SpawnPlacer::LoadState(SnapshotReader& reader) {
+    reader.Read(areaWidth);
+    reader.Read(areaHeight);
+    reader.Read(cellSize);
+    reader.Read(columns);
+    reader.Read(rows);
+    reader.ReadVector(cells);
+}
+
+size_t SpawnPlacer::GetStateCapacity() const {
+    return 3 * sizeof(float) + 2 * sizeof(int) + sizeof(uint64_t) + cells.size() * sizeof(uint32_t);
+}
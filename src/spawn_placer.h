@@ -0,0 +1,69 @@
+#ifndef SPAWN_PLACER_H
+#define SPAWN_PLACER_H
+
+#include "core_types.h"
+#include "random.h"
+#include "snapshot.h"
+#include "frame_arena.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Stratified spawn placement. The spawn area is split into cells a bit larger
+// than the bodies being placed, and each placement takes a distinct random cell
+// and a random point inside it that keeps the body within the cell. Bodies in
+// different cells can't overlap, and cells too close to the avoid point are
+// skipped as a whole, so there is no open-ended rejection loop: a call is
+// bounded by the number of cells and never allocates once the cell table and
+// the output are sized.
+class SpawnPlacer {
+public:
+    SpawnPlacer();
+
+    // Positions are top-left corners within [0, areaWidth] x [0, areaHeight]
+    void SetArea(float areaWidth, float areaHeight);
+
+    // Fills `out` (cleared first) with `count` positions for bodies up to
+    // bodySize wide whose top-left corner stays at least avoidDistance from
+    // `avoid`. Placements only overlap once count exceeds the free cells, and
+    // if the avoid zone covers every cell it is ignored.
+    void Place(Random& random, size_t count, float bodySize, Vector2 avoid, float avoidDistance,
+               FrameVector<Vector2>& out);
+
+    // Sizes the cell table for bodies down to bodySize in the current area,
+    // so Place doesn't allocate when the body size changes
+    void Reserve(float bodySize);
+
+    size_t GetCellCount() const;
+
+    // The cell order carries over between calls, so it is part of the state
+    void SaveState(Snapshot& snapshot) const;
+    void LoadState(SnapshotReader& reader);
+    // Bytes SaveState writes for the current cell table
+    size_t GetStateCapacity() const;
+
+private:
+    struct Exclusion {
+        Vector2 center;
+        float distanceSquared;
+    };
+
+    float areaWidth;
+    float areaHeight;
+    float cellSize;
+    int columns;
+    int rows;
+    std::vector<uint32_t> cells; // Every cell index once, in shuffled order
+
+    void BuildCells(float bodySize);
+    // Small requests shuffle a few cells; large ones sweep them in order
+    void PlaceShuffled(Random& random, size_t wanted, const Exclusion& exclusion, float jitter,
+                       FrameVector<Vector2>& out);
+    void PlaceInOrder(Random& random, size_t wanted, size_t clearCells, const Exclusion& exclusion,
+                      float jitter, FrameVector<Vector2>& out);
+    void Emit(Random& random, int column, int row, float jitter, FrameVector<Vector2>& out) const;
+    size_t CountClearCells(const Exclusion& exclusion) const;
+    bool IsCellClear(int column, int row, const Exclusion& exclusion) const;
+};
+
+#endif // SPAWN_PLACER_H
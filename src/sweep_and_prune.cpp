@@ -0,0 +1,110 @@
+#include "sweep_and_prune.h"
+#include <algorithm>
+
+SweepAndPrune::SweepAndPrune() : added(0) {}
+
+void SweepAndPrune::Reserve(size_t capacity) {
+    bodies.reserve(capacity);
+    keys.reserve(capacity);
+    sortedMinX.reserve(capacity);
+    sortedMinY.reserve(capacity);
+    sortedMaxY.reserve(capacity);
+}
+
+void SweepAndPrune::Clear() {
+    bodies.clear();
+    added = 0;
+}
+
+void SweepAndPrune::Add(const SweepBody& body) {
+    bodies.push_back(body);
+    added++;
+}
+
+void SweepAndPrune::Sort() {
+    // New bodies land anywhere, so a large batch of them (a wave spawning)
+    // is cheaper to sort from scratch than to insert one by one
+    if (added > 32) {
+        std::sort(bodies.begin(), bodies.end(), Before);
+    } else {
+        InsertionSort();
+    }
+    added = 0;
+
+    sortedMinX.resize(bodies.size());
+    sortedMinY.resize(bodies.size());
+    sortedMaxY.resize(bodies.size());
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        sortedMinX[i] = bodies[i].minX;
+        sortedMinY[i] = bodies[i].minY;
+        sortedMaxY[i] = bodies[i].maxY;
+    }
+}
+
+void SweepAndPrune::InsertionSort() {
+    for (size_t i = 1; i < bodies.size(); ++i) {
+        if (!Before(bodies[i], bodies[i - 1])) continue;
+        const SweepBody body = bodies[i];
+        size_t j = i;
+        do {
+            bodies[j] = bodies[j - 1];
+            --j;
+        } while (j > 0 && Before(body, bodies[j - 1]));
+        bodies[j] = body;
+    }
+}
+
+void SweepAndPrune::FindPairs(FrameVector<SweepPair>& out) const {
+    const size_t count = bodies.size();
+    const float* minX = sortedMinX.data();
+    const float* minY = sortedMinY.data();
+    const float* maxY = sortedMaxY.data();
+    for (size_t i = 0; i < count; ++i) {
+        // Copied out so the appends below can't force them to be reloaded
+        const float right = bodies[i].maxX;
+        const float top = bodies[i].minY;
+        const float bottom = bodies[i].maxY;
+        // Everything further on starts further right; stop at the first body
+        // that starts past this one's right edge. Most bodies in range miss
+        // along y, so the loop only reads the packed columns it tests, and
+        // folds both y tests into one (a < b exactly when a - b < 0) so the
+        // only branch is the rarely taken one.
+        for (size_t j = i + 1; j < count && minX[j] < right; ++j) {
+            if (std::max(minY[j] - bottom, top - maxY[j]) < 0.0f) {
+                out.push_back({ bodies[i].index, bodies[j].index });
+            }
+        }
+    }
+}
+
+size_t SweepAndPrune::Count() const {
+    return bodies.size();
+}
+
+void SweepAndPrune::SaveState(Snapshot& snapshot) const {
+    const uint64_t count = bodies.size();
+    snapshot.Write(count);
+    for (const SweepBody& body : bodies) {
+        snapshot.Write(body.key);
+    }
+}
+
+void SweepAndPrune::LoadState(SnapshotReader& reader) {
+    uint64_t count = 0;
+    reader.Read(count);
+    keys.resize(static_cast<size_t>(count));
+    reader.ReadArray(keys.data(), keys.size());
+    bodies.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        bodies[i] = SweepBody{ 0.0f, 0.0f, 0.0f, 0.0f, keys[i], 0 };
+    }
+    added = 0;
+}
+
+size_t SweepAndPrune::GetStateCapacity(size_t bodyCount) const {
+    return sizeof(uint64_t) + bodyCount * sizeof(uint32_t);
+}
+
+bool SweepAndPrune::Before(const SweepBody& a, const SweepBody& b) {
+    return a.minX < b.minX || (a.minX == b.minX && a.key < b.key);
+}
@@ -0,0 +1,82 @@
+#ifndef SWEEP_AND_PRUNE_H
+#define SWEEP_AND_PRUNE_H
+
+#include "snapshot.h"
+#include "frame_arena.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// A body as the sweep sees it: its bounds, a stable key that identifies it
+// from step to step, and an index the caller gets back in pairs
+struct SweepBody {
+    float minX;
+    float maxX;
+    float minY;
+    float maxY;
+    uint32_t key;
+    uint32_t index;
+};
+
+struct SweepPair {
+    uint32_t first;  // Index of the body further left
+    uint32_t second;
+};
+
+// Sort-and-sweep broadphase along the x axis. Bodies stay in a list sorted by
+// their left edge from one step to the next; bodies move little between
+// steps, so the list is nearly sorted and an insertion sort puts it back in
+// order in close to linear time. A sweep over the sorted list then only
+// compares bodies whose x ranges overlap.
+//
+// Ties on the left edge are broken by key, so the order, and with it the
+// order pairs come out in, is the same on every platform.
+class SweepAndPrune {
+public:
+    SweepAndPrune();
+
+    void Reserve(size_t capacity);
+    void Clear();
+
+    // Starts a step. refresh(body) is called on every body kept from the last
+    // step, in list order, to update its bounds and index; it returns false
+    // to drop a body that no longer exists.
+    template <typename Update>
+    void Refresh(Update refresh) {
+        size_t kept = 0;
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            SweepBody body = bodies[i];
+            if (refresh(body)) bodies[kept++] = body;
+        }
+        bodies.resize(kept);
+        added = 0;
+    }
+    // Adds a body that wasn't in the list last step
+    void Add(const SweepBody& body);
+    // Restores the order after Refresh and Add
+    void Sort();
+    // Appends every pair whose bounds overlap (strictly, like
+    // CheckCollisionRecs), ordered by the first body's place in the list
+    void FindPairs(FrameVector<SweepPair>& out) const;
+
+    size_t Count() const;
+
+    // Only the keys, in list order, are state; bounds are refreshed every step
+    void SaveState(Snapshot& snapshot) const;
+    void LoadState(SnapshotReader& reader);
+    size_t GetStateCapacity(size_t bodyCount) const;
+
+private:
+    std::vector<SweepBody> bodies; // Sorted by minX, then key
+    std::vector<uint32_t> keys;    // Scratch for LoadState
+    // Copies of the columns the sweep tests, in list order, made by Sort
+    std::vector<float> sortedMinX;
+    std::vector<float> sortedMinY;
+    std::vector<float> sortedMaxY;
+    size_t added;                  // Bodies added since the last Refresh
+
+    void InsertionSort();
+    static bool Before(const SweepBody& a, const SweepBody& b);
+};
+
+#endif // SWEEP_AND_PRUNE_H
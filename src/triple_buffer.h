@@ -0,0 +1,42 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-off of whole values from one writer thread to one reader
+// thread. The writer fills its back slot and publishes it; the reader fetches
+// the newest published slot. Each side owns one slot and the third sits in
+// the middle, swapped with a single atomic exchange, so neither side ever
+// waits for the other. A reader slower than the writer skips the values it
+// never fetched; a faster one keeps the last value it fetched.
+template<typename T>
+class TripleBuffer {
+public:
+    // Writer: fill the back slot, then publish it. Publishing hands over a
+    // slot the reader may have seen before, so fill it completely.
+    T& GetBack() { return slots[back]; }
+    void Publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader: swaps in the newest published slot; false if nothing was
+    // published since the last fetch
+    bool Fetch() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& GetFront() const { return slots[front]; }
+
+private:
+    static const uint8_t INDEX = 3;
+    static const uint8_t FRESH = 4; // Set while the middle slot is unread
+
+    T slots[3];
+    uint8_t back = 0;                   // Writer's
+    alignas(64) std::atomic<uint8_t> middle{ 1 };
+    alignas(64) uint8_t front = 2;      // Reader's
+};
+
+#endif // TRIPLE_BUFFER_H